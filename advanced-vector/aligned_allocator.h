@@ -0,0 +1,66 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cstddef>
+#include <limits>
+#include <new>
+
+// Аллокатор, выравнивающий буфер по границе Alignment байт (степени двойки, не меньше alignof(T)).
+// Позволяет получать буферы, выровненные по кэш-линии (64) для SIMD-кода или по странице (4096)
+// для O_DIRECT. Для типов с повышенным выравниванием достаточно и std::allocator
+template <typename T, size_t Alignment = alignof(T)>
+class AlignedAllocator {
+    static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+    static_assert(Alignment >= alignof(T), "Alignment must not be weaker than alignof(T)");
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, (Alignment > alignof(U) ? Alignment : alignof(U))>;
+    };
+
+    static constexpr size_t ALIGNMENT = Alignment;
+
+    AlignedAllocator() = default;
+
+    template <typename U, size_t OtherAlignment>
+    AlignedAllocator(const AlignedAllocator<U, OtherAlignment>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        if constexpr (Alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            return static_cast<T*>(operator new(n * sizeof(T), std::align_val_t{Alignment}));
+        } else {
+            return static_cast<T*>(operator new(n * sizeof(T)));
+        }
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        if constexpr (Alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            operator delete(ptr, n * sizeof(T), std::align_val_t{Alignment});
+        } else {
+            operator delete(ptr, n * sizeof(T));
+        }
+    }
+
+    template <typename U, size_t OtherAlignment>
+    bool operator==(const AlignedAllocator<U, OtherAlignment>&) const noexcept {
+        return true;
+    }
+
+    template <typename U, size_t OtherAlignment>
+    bool operator!=(const AlignedAllocator<U, OtherAlignment>&) const noexcept {
+        return false;
+    }
+};
+
+// Вектор, буфер которого выровнен по границе Alignment байт
+template <typename T, size_t Alignment, typename GrowthPolicy = DoublingGrowth>
+using AlignedVector = Vector<T, AlignedAllocator<T, Alignment>, GrowthPolicy>;
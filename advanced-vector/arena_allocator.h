@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <utility>
+
+// Монотонная арена: выделяет память из крупных блоков простым сдвигом указателя и освобождает
+// всё разом при вызове Reset() или разрушении. Удобна для объектов, живущих в пределах одного запроса.
+// Не потокобезопасна: каждому потоку (запросу) нужна своя арена
+class Arena {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    explicit Arena(size_t block_size = DEFAULT_BLOCK_SIZE)
+        : block_size_(block_size) {
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() {
+        Release();
+    }
+
+    // Выделяет bytes байт, выровненных по alignment (степени двойки)
+    void* Allocate(size_t bytes, size_t alignment) {
+        assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+        if (void* result = TryBump(bytes, alignment)) {
+            return result;
+        }
+        AddBlock(bytes, alignment);
+        void* result = TryBump(bytes, alignment);
+        assert(result != nullptr);
+        return result;
+    }
+
+    // Память возвращается арене только если это последнее выделение (например, при PopBack
+    // единственного буфера), в остальных случаях она освобождается вместе с ареной
+    void Deallocate(void* ptr, size_t bytes) noexcept {
+        if (static_cast<char*>(ptr) + bytes == top_) {
+            top_ = static_cast<char*>(ptr);
+        }
+    }
+
+    // Освобождает все блоки, кроме последнего, который переиспользуется с начала
+    void Reset() noexcept {
+        if (head_ == nullptr) {
+            return;
+        }
+        Block* last = head_;
+        head_ = std::exchange(last->prev, nullptr);
+        Release();
+        head_ = last;
+        top_ = last->Begin();
+        end_ = last->End();
+        bytes_reserved_ = last->size;
+    }
+
+    // Суммарный объём памяти, полученной ареной от системы
+    size_t BytesReserved() const noexcept {
+        return bytes_reserved_;
+    }
+
+private:
+    struct Block {
+        Block* prev;
+        size_t size;
+
+        char* Begin() noexcept {
+            return reinterpret_cast<char*>(this + 1);
+        }
+        char* End() noexcept {
+            return reinterpret_cast<char*>(this) + size;
+        }
+    };
+
+    void* TryBump(size_t bytes, size_t alignment) noexcept {
+        if (top_ == nullptr) {
+            return nullptr;
+        }
+        const size_t misalignment = reinterpret_cast<std::uintptr_t>(top_) & (alignment - 1);
+        const size_t padding = misalignment == 0 ? 0 : alignment - misalignment;
+        const size_t available = static_cast<size_t>(end_ - top_);
+        if (padding > available || bytes > available - padding) {
+            return nullptr;
+        }
+        char* result = top_ + padding;
+        top_ = result + bytes;
+        return result;
+    }
+
+    void AddBlock(size_t bytes, size_t alignment) {
+        if (bytes > std::numeric_limits<size_t>::max() - sizeof(Block) - alignment) {
+            throw std::bad_alloc();
+        }
+        const size_t size = std::max(block_size_, sizeof(Block) + alignment + bytes);
+        auto* block = static_cast<Block*>(operator new(size));
+        block->prev = head_;
+        block->size = size;
+        head_ = block;
+        top_ = block->Begin();
+        end_ = block->End();
+        bytes_reserved_ += size;
+    }
+
+    void Release() noexcept {
+        while (head_ != nullptr) {
+            Block* prev = head_->prev;
+            operator delete(head_);
+            head_ = prev;
+        }
+        top_ = end_ = nullptr;
+        bytes_reserved_ = 0;
+    }
+
+    size_t block_size_;
+    Block* head_ = nullptr;
+    char* top_ = nullptr;
+    char* end_ = nullptr;
+    size_t bytes_reserved_ = 0;
+};
+
+// Аллокатор, выделяющий память из арены. Как и std::pmr::polymorphic_allocator, не распространяется
+// при копировании, перемещении и обмене контейнеров: элементы всегда остаются в своей арене
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(Arena& arena) noexcept
+        : arena_(&arena) {
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+        : arena_(&other.GetArena()) {
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        arena_->Deallocate(ptr, n * sizeof(T));
+    }
+
+    Arena& GetArena() const noexcept {
+        return *arena_;
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept {
+        return arena_ == &other.GetArena();
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    Arena* arena_;
+};
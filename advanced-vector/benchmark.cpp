@@ -0,0 +1,428 @@
+// Сравнение производительности Vector и std::vector.
+// Сборка: g++ -std=c++17 -O2 -DNDEBUG benchmark.cpp -o benchmark
+// Запуск: ./benchmark [--max-size=N] [--filter=подстрока_названия_сценария]
+//
+// Для каждого сценария и размера печатаются время на операцию, число выделений памяти
+// и объём перенесённых контейнером данных: для Record — по числу копирований и перемещений
+// элементов, для int — по буферам, освобождённым при росте, и по элементам, сдвинутым вставкой и удалением
+
+#include "vector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+struct AllocationStats {
+    size_t allocations = 0;
+    size_t bytes_allocated = 0;
+    size_t bytes_released = 0;
+};
+
+AllocationStats g_allocation_stats;
+
+// Аллокатор, подсчитывающий выделения памяти
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        ++g_allocation_stats.allocations;
+        g_allocation_stats.bytes_allocated += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        g_allocation_stats.bytes_released += n * sizeof(T);
+        std::allocator<T>().deallocate(ptr, n);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+// Запись со строкой, аналог Obj из тестов, считающая копирования и перемещения
+struct Record {
+    Record() = default;
+
+    Record(int id, std::string name)
+        : id(id)
+        , name(std::move(name)) {
+    }
+
+    Record(const Record& other)
+        : id(other.id)
+        , name(other.name) {
+        ++num_transfers;
+    }
+
+    Record(Record&& other) noexcept
+        : id(other.id)
+        , name(std::move(other.name)) {
+        ++num_transfers;
+    }
+
+    Record& operator=(const Record& other) {
+        id = other.id;
+        name = other.name;
+        ++num_transfers;
+        return *this;
+    }
+
+    Record& operator=(Record&& other) noexcept {
+        id = other.id;
+        name = std::move(other.name);
+        ++num_transfers;
+        return *this;
+    }
+
+    int id = 0;
+    std::string name;
+
+    static inline size_t num_transfers = 0;
+};
+
+template <typename T>
+using StdVector = std::vector<T, CountingAllocator<T>>;
+
+template <typename T>
+using OurVector = Vector<T, CountingAllocator<T>>;
+
+// Единый интерфейс к обоим контейнерам
+
+template <typename T, typename U>
+void Add(StdVector<T>& v, U&& value) {
+    v.push_back(std::forward<U>(value));
+}
+
+template <typename T, typename U>
+void Add(OurVector<T>& v, U&& value) {
+    v.PushBack(std::forward<U>(value));
+}
+
+template <typename T, typename... Args>
+void Emplace(StdVector<T>& v, Args&&... args) {
+    v.emplace_back(std::forward<Args>(args)...);
+}
+
+template <typename T, typename... Args>
+void Emplace(OurVector<T>& v, Args&&... args) {
+    v.EmplaceBack(std::forward<Args>(args)...);
+}
+
+template <typename T>
+void Reserve(StdVector<T>& v, size_t n) {
+    v.reserve(n);
+}
+
+template <typename T>
+void Reserve(OurVector<T>& v, size_t n) {
+    v.Reserve(n);
+}
+
+// Пакетная дозапись n последовательных чисел. У std::vector её нет, с ней сравнивается push_back<int>
+template <typename T>
+void AppendCounting(OurVector<T>& v, size_t n) {
+    auto appender = v.BatchAppend();
+    for (size_t i = 0; i < n; ++i) {
+        appender.PushBack(static_cast<T>(i));
+    }
+}
+
+template <typename T>
+void InsertAt(StdVector<T>& v, size_t pos, const T& value) {
+    v.insert(v.begin() + pos, value);
+}
+
+template <typename T>
+void InsertAt(OurVector<T>& v, size_t pos, const T& value) {
+    v.Insert(v.cbegin() + pos, value);
+}
+
+template <typename T>
+void EraseAt(StdVector<T>& v, size_t pos) {
+    v.erase(v.begin() + pos);
+}
+
+template <typename T>
+void EraseAt(OurVector<T>& v, size_t pos) {
+    v.Erase(v.cbegin() + pos);
+}
+
+template <typename T>
+size_t SizeOf(const StdVector<T>& v) {
+    return v.size();
+}
+
+template <typename T>
+size_t SizeOf(const OurVector<T>& v) {
+    return v.Size();
+}
+
+// Не даёт компилятору выбросить результаты вычислений
+template <typename T>
+void DoNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Measurement {
+    double ns_per_op = 0;
+    double allocations = 0;
+    double bytes_moved = 0;
+};
+
+// Буферы, освобождённые за время жизни контейнера, освобождаются при перевыделении,
+// а значит, их содержимое было перенесено. Буфер, освобождаемый деструктором, не считается
+size_t g_bytes_relocated = 0;
+
+class RelocationScope {
+public:
+    RelocationScope() noexcept
+        : mark_(g_allocation_stats.bytes_released) {
+    }
+
+    // Вызывается, пока контейнер ещё жив
+    void Commit() noexcept {
+        g_bytes_relocated += g_allocation_stats.bytes_released - mark_;
+    }
+
+private:
+    size_t mark_;
+};
+
+// Байты, сдвинутые внутри буфера вставками и удалениями в середине. Для Record сдвиги и так видны
+// по числу перемещений, поэтому счётчик учитывается только для остальных типов
+size_t g_bytes_shifted = 0;
+
+// Выполняет body() repetitions раз и усредняет результаты на одно повторение.
+// body возвращает число выполненных операций, по которому считается время на операцию
+// Для Record перенесённые байты считаются по числу копирований и перемещений,
+// для остальных типов — по освобождённым при росте буферам и сдвинутым элементам
+template <typename T, typename Body>
+Measurement Measure(size_t repetitions, Body body) {
+    g_allocation_stats = {};
+    g_bytes_relocated = 0;
+    g_bytes_shifted = 0;
+    Record::num_transfers = 0;
+    size_t ops = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repetitions; ++i) {
+        ops += body();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+
+    Measurement result;
+    result.ns_per_op = ns / static_cast<double>(std::max<size_t>(ops, 1));
+    result.allocations = static_cast<double>(g_allocation_stats.allocations) / repetitions;
+    const size_t bytes_moved =
+        std::is_same_v<T, Record> ? Record::num_transfers * sizeof(Record) : g_bytes_relocated + g_bytes_shifted;
+    result.bytes_moved = static_cast<double>(bytes_moved) / repetitions;
+    return result;
+}
+
+constexpr const char* RECORD_NAME = "record name long enough to allocate";
+
+template <typename Container>
+size_t PushBackInts(size_t n, bool reserve) {
+    RelocationScope scope;
+    Container v;
+    if (reserve) {
+        Reserve(v, n);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        Add(v, static_cast<int>(i));
+    }
+    DoNotOptimize(v);
+    scope.Commit();
+    return n;
+}
+
+template <typename Container>
+size_t BatchAppendInts(size_t n) {
+    RelocationScope scope;
+    Container v;
+    AppendCounting(v, n);
+    DoNotOptimize(v);
+    scope.Commit();
+    return n;
+}
+
+template <typename Container>
+size_t EmplaceRecords(size_t n) {
+    RelocationScope scope;
+    Container v;
+    for (size_t i = 0; i < n; ++i) {
+        Emplace(v, static_cast<int>(i), RECORD_NAME);
+    }
+    DoNotOptimize(v);
+    scope.Commit();
+    return n;
+}
+
+template <typename T, typename Container>
+size_t MiddleInsertErase(Container& v, const T& value, size_t ops) {
+    RelocationScope scope;
+    for (size_t i = 0; i < ops; ++i) {
+        const size_t size = SizeOf(v);
+        const size_t pos = size / 2;
+        InsertAt(v, pos, value);
+        // элементы [pos, size) сдвигаются на одну позицию вправо
+        g_bytes_shifted += (size - pos) * sizeof(T);
+    }
+    for (size_t i = 0; i < ops; ++i) {
+        const size_t size = SizeOf(v);
+        const size_t pos = size / 2;
+        EraseAt(v, pos);
+        g_bytes_shifted += (size - pos - 1) * sizeof(T);
+    }
+    scope.Commit();
+    return ops * 2;
+}
+
+template <typename Container>
+size_t CopyAssign(Container& dst, const Container& src) {
+    RelocationScope scope;
+    dst = src;
+    DoNotOptimize(dst);
+    scope.Commit();
+    return SizeOf(src);
+}
+
+struct Options {
+    size_t max_size = 1'000'000;
+    std::string_view filter;
+};
+
+void PrintHeader() {
+    std::printf("%-28s %-12s %10s %12s %12s %16s\n", "workload", "container", "size", "ns/op", "allocs", "bytes moved");
+}
+
+void PrintRow(std::string_view workload, std::string_view container, size_t size, const Measurement& m) {
+    std::printf("%-28.*s %-12.*s %10zu %12.2f %12.1f %16.0f\n", static_cast<int>(workload.size()), workload.data(),
+                static_cast<int>(container.size()), container.data(), size, m.ns_per_op, m.allocations,
+                m.bytes_moved);
+}
+
+constexpr size_t ELEMENTS_PER_WORKLOAD = 10'000'000;
+constexpr size_t MAX_MIDDLE_INSERT_SIZE = 10'000'000;
+constexpr size_t MIDDLE_INSERT_OPS = 100;
+
+// Число повторений, при котором сценарий обработает порядка ELEMENTS_PER_WORKLOAD элементов
+size_t RepetitionsFor(size_t size) {
+    return std::max<size_t>(1, ELEMENTS_PER_WORKLOAD / size);
+}
+
+// Прогоняет все сценарии одного размера на контейнере Container
+template <template <typename> typename Container>
+void RunWorkloads(std::string_view name, size_t size, const Options& options) {
+    const auto enabled = [&](std::string_view workload) {
+        return options.filter.empty() || workload.find(options.filter) != std::string_view::npos;
+    };
+    const size_t repetitions = RepetitionsFor(size);
+    // записи со строками заметно дороже int, поэтому для них повторений меньше
+    const size_t record_repetitions = std::max<size_t>(1, repetitions / 10);
+
+    if (enabled("push_back<int>")) {
+        PrintRow("push_back<int>", name, size, Measure<int>(repetitions, [&] {
+                     return PushBackInts<Container<int>>(size, false);
+                 }));
+    }
+    if (enabled("push_back_reserved<int>")) {
+        PrintRow("push_back_reserved<int>", name, size, Measure<int>(repetitions, [&] {
+                     return PushBackInts<Container<int>>(size, true);
+                 }));
+    }
+    if constexpr (std::is_same_v<Container<int>, OurVector<int>>) {
+        if (enabled("batch_append<int>")) {
+            PrintRow("batch_append<int>", name, size, Measure<int>(repetitions, [&] {
+                         return BatchAppendInts<Container<int>>(size);
+                     }));
+        }
+    }
+    if (enabled("emplace_back<Record>")) {
+        PrintRow("emplace_back<Record>", name, size, Measure<Record>(record_repetitions, [&] {
+                     return EmplaceRecords<Container<Record>>(size);
+                 }));
+    }
+    // вставка в середину линейна по размеру, поэтому выполняется ограниченное число операций
+    if (enabled("middle_insert_erase") && size <= MAX_MIDDLE_INSERT_SIZE) {
+        const size_t ops = std::min<size_t>(size, MIDDLE_INSERT_OPS);
+        Container<int> ints;
+        Container<Record> records;
+        Reserve(ints, size + ops);
+        Reserve(records, size + ops);
+        for (size_t i = 0; i < size; ++i) {
+            Add(ints, static_cast<int>(i));
+            Emplace(records, static_cast<int>(i), RECORD_NAME);
+        }
+        PrintRow("middle_insert_erase<int>", name, size, Measure<int>(1, [&] {
+                     return MiddleInsertErase(ints, 42, ops);
+                 }));
+        const Record record(1, RECORD_NAME);
+        PrintRow("middle_insert_erase<Record>", name, size, Measure<Record>(1, [&] {
+                     return MiddleInsertErase(records, record, ops);
+                 }));
+    }
+    if (enabled("copy_assign<Record>")) {
+        Container<Record> src;
+        Container<Record> dst;
+        for (size_t i = 0; i < size; ++i) {
+            Emplace(src, static_cast<int>(i), RECORD_NAME);
+            Emplace(dst);
+        }
+        PrintRow("copy_assign<Record>", name, size, Measure<Record>(record_repetitions, [&] {
+                     return CopyAssign(dst, src);
+                 }));
+    }
+}
+
+Options ParseOptions(int argc, char** argv) {
+    using namespace std::literals;
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg.substr(0, "--max-size="sv.size()) == "--max-size="sv) {
+            options.max_size = std::stoull(std::string(arg.substr("--max-size="sv.size())));
+        } else if (arg.substr(0, "--filter="sv.size()) == "--filter="sv) {
+            options.filter = arg.substr("--filter="sv.size());
+        } else {
+            std::fprintf(stderr, "Usage: %s [--max-size=N] [--filter=WORKLOAD]\n", argv[0]);
+            std::exit(1);
+        }
+    }
+    return options;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const Options options = ParseOptions(argc, argv);
+    PrintHeader();
+    for (size_t size = 10; size <= options.max_size; size *= 10) {
+        RunWorkloads<StdVector>("std::vector", size, options);
+        RunWorkloads<OurVector>("Vector", size, options);
+        if (size > options.max_size / 10) {
+            break;
+        }
+    }
+}
@@ -0,0 +1,305 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+// Вектор, в конец которого могут одновременно добавлять элементы несколько потоков без блокировок.
+// Элементы хранятся в сегментах (RawMemory) удваивающегося размера: сегмент k вмещает
+// FIRST_SEGMENT_SIZE << k элементов. Опубликованные элементы никогда не переносятся, поэтому ссылки
+// и индексы на них действительны до разрушения вектора. Позиция нового элемента занимается атомарным
+// fetch_add, сегмент выделяется первым потоком, которому он понадобился.
+// Удаление элементов не поддерживается. Читатели обходят готовые элементы при помощи Snapshot
+template <typename T, typename Allocator = std::allocator<T>>
+class ConcurrentVector {
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
+    static constexpr size_t FIRST_SEGMENT_SIZE = 32;
+
+    class Snapshot;
+
+    ConcurrentVector() = default;
+
+    explicit ConcurrentVector(const Allocator& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    ConcurrentVector(const ConcurrentVector&) = delete;
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+    // Вызывается, когда добавления завершены
+    ~ConcurrentVector() {
+        const size_t size = size_.load(std::memory_order_acquire);
+        for (size_t k = 0; k < MAX_SEGMENTS; ++k) {
+            Segment* segment = segments_[k].load(std::memory_order_acquire);
+            if (segment == nullptr) {
+                continue;
+            }
+            const size_t first = SegmentStart(k);
+            const size_t count = size > first ? std::min(size - first, SegmentSize(k)) : 0;
+            for (size_t i = 0; i < count; ++i) {
+                if (segment->states[i].load(std::memory_order_relaxed) == READY) {
+                    std::destroy_at(segment->elements.GetAddress() + i);
+                }
+            }
+            delete segment;
+        }
+    }
+
+    // Создаёт элемент в конце вектора и возвращает ссылку на него, действительную до разрушения вектора.
+    // Безопасен при одновременном вызове из разных потоков. Если конструктор элемента выбросит исключение,
+    // занятая позиция останется пустой и будет пропущена при обходе. Если не удастся выделить сегмент,
+    // выбрасывается std::bad_alloc, и граница опубликованных элементов дальше этой позиции не продвинется
+    // (элементы за ней по-прежнему доступны по индексу)
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        const size_t index = size_.fetch_add(1, std::memory_order_relaxed);
+        if (index >= MAX_SIZE) {
+            throw std::length_error("ConcurrentVector capacity overflow");
+        }
+        const auto [k, offset] = Locate(index);
+        Segment& segment = AcquireSegment(k);
+        T* value = nullptr;
+        try {
+            value = new (segment.elements.GetAddress() + offset) T(std::forward<Args>(args)...);
+        }
+        catch (...) {
+            segment.states[offset].store(FAILED, std::memory_order_seq_cst);
+            Publish();
+            throw;
+        }
+        segment.states[offset].store(READY, std::memory_order_seq_cst);
+        Publish();
+        return *value;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    // Доступ к элементу, о готовности которого известно (например, полученному из EmplaceBack или Snapshot)
+    T& operator[](size_t index) noexcept {
+        VECTOR_CHECK(IsReady(index), "element %zu is not constructed", index);
+        const auto [k, offset] = Locate(index);
+        return segments_[k].load(std::memory_order_acquire)->elements[offset];
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<ConcurrentVector&>(*this)[index];
+    }
+
+    // Число занятых позиций, включая элементы, которые ещё создаются
+    size_t Size() const noexcept {
+        return std::min(size_.load(std::memory_order_acquire), MAX_SIZE);
+    }
+
+    // Длина начального отрезка, все элементы которого уже созданы (или не были созданы из-за исключения)
+    size_t PublishedSize() const noexcept {
+        return published_.load(std::memory_order_acquire);
+    }
+
+    // Истинно, если элемент index создан и его можно читать
+    bool IsReady(size_t index) const noexcept {
+        return State(index) == READY;
+    }
+
+    // Снимок опубликованных элементов: последующие добавления в него не попадают
+    Snapshot GetSnapshot() const noexcept {
+        return Snapshot(*this, PublishedSize());
+    }
+
+    const Allocator& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+private:
+    // Состояния позиций
+    static constexpr unsigned char EMPTY = 0;
+    static constexpr unsigned char READY = 1;
+    static constexpr unsigned char FAILED = 2;
+
+    struct Segment {
+        Segment(size_t size, const Allocator& alloc)
+            : elements(size, alloc)
+            , states(new std::atomic<unsigned char>[size]()) {
+        }
+
+        RawMemory<T, Allocator> elements;
+        std::unique_ptr<std::atomic<unsigned char>[]> states;
+    };
+
+    static constexpr size_t LOG_FIRST_SEGMENT_SIZE = 5;
+    static_assert(FIRST_SEGMENT_SIZE == size_t{1} << LOG_FIRST_SEGMENT_SIZE);
+    static constexpr size_t MAX_SEGMENTS = std::numeric_limits<size_t>::digits - LOG_FIRST_SEGMENT_SIZE;
+    static constexpr size_t MAX_SIZE = std::numeric_limits<size_t>::max() - FIRST_SEGMENT_SIZE + 1;
+
+    static size_t HighestBit(size_t value) noexcept {
+#if defined(__GNUC__)
+        return std::numeric_limits<unsigned long long>::digits - 1 - __builtin_clzll(value);
+#else
+        size_t bit = 0;
+        while (value >>= 1) {
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+
+    static size_t SegmentSize(size_t k) noexcept {
+        return FIRST_SEGMENT_SIZE << k;
+    }
+
+    static size_t SegmentStart(size_t k) noexcept {
+        return SegmentSize(k) - FIRST_SEGMENT_SIZE;
+    }
+
+    // Номер сегмента и позиция в нём для элемента index
+    static std::pair<size_t, size_t> Locate(size_t index) noexcept {
+        const size_t adjusted = index + FIRST_SEGMENT_SIZE;
+        const size_t bit = HighestBit(adjusted);
+        return {bit - LOG_FIRST_SEGMENT_SIZE, adjusted - (size_t{1} << bit)};
+    }
+
+    // Возвращает сегмент k, выделяя его при необходимости. Если сегмент одновременно выделили
+    // несколько потоков, публикуется первый, а остальные освобождаются
+    Segment& AcquireSegment(size_t k) {
+        Segment* segment = segments_[k].load(std::memory_order_acquire);
+        if (segment == nullptr) {
+            auto fresh = std::make_unique<Segment>(SegmentSize(k), alloc_);
+            // seq_cst, чтобы установка сегмента была упорядочена с чтениями в Publish (см. там)
+            if (segments_[k].compare_exchange_strong(segment, fresh.get(), std::memory_order_seq_cst,
+                                                     std::memory_order_acquire)) {
+                segment = fresh.release();
+            }
+        }
+        return *segment;
+    }
+
+    // Позиции, которые ещё никем не заняты, пусты: состояния нового сегмента инициализируются EMPTY
+    unsigned char State(size_t index, std::memory_order order = std::memory_order_acquire) const noexcept {
+        if (index >= MAX_SIZE) {
+            return EMPTY;
+        }
+        const auto [k, offset] = Locate(index);
+        const Segment* segment = segments_[k].load(order);
+        return segment != nullptr ? segment->states[offset].load(order) : EMPTY;
+    }
+
+    // Продвигает границу опубликованных элементов через все завершённые позиции
+    // Состояние своей позиции записывается, а граница, сегменты и чужие состояния читаются с seq_cst:
+    // acquire/release не упорядочивает запись с последующим чтением, и два потока, завершившие соседние
+    // позиции, могли бы не увидеть записей друг друга и оба остановить границу перед готовыми элементами.
+    // В едином порядке seq_cst-операций один из них обязательно увидит позицию другого
+    void Publish() noexcept {
+        size_t published = published_.load(std::memory_order_seq_cst);
+        while (State(published, std::memory_order_seq_cst) != EMPTY) {
+            if (published_.compare_exchange_weak(published, published + 1, std::memory_order_acq_rel,
+                                                 std::memory_order_acquire)) {
+                ++published;
+            }
+            // при неудаче published уже содержит текущую границу
+        }
+    }
+
+    [[no_unique_address]] Allocator alloc_;
+    std::atomic<size_t> size_ = 0;
+    std::atomic<size_t> published_ = 0;
+    std::atomic<Segment*> segments_[MAX_SEGMENTS] = {};
+};
+
+// Неизменяемый вид на элементы [0, PublishedSize()) на момент создания снимка.
+// Итераторы пропускают позиции, элементы которых не были созданы из-за исключения
+template <typename T, typename Allocator>
+class ConcurrentVector<T, Allocator>::Snapshot {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        Iterator(const ConcurrentVector* vector, size_t index, size_t end) noexcept
+            : vector_(vector)
+            , index_(index)
+            , end_(end) {
+            SkipFailed();
+        }
+
+        reference operator*() const noexcept {
+            return (*vector_)[index_];
+        }
+        pointer operator->() const noexcept {
+            return &**this;
+        }
+        Iterator& operator++() noexcept {
+            ++index_;
+            SkipFailed();
+            return *this;
+        }
+        Iterator operator++(int) noexcept {
+            Iterator result = *this;
+            ++*this;
+            return result;
+        }
+        bool operator==(const Iterator& other) const noexcept {
+            return index_ == other.index_;
+        }
+        bool operator!=(const Iterator& other) const noexcept {
+            return index_ != other.index_;
+        }
+
+        // Индекс элемента в векторе
+        size_t Index() const noexcept {
+            return index_;
+        }
+
+    private:
+        void SkipFailed() noexcept {
+            while (index_ != end_ && !vector_->IsReady(index_)) {
+                ++index_;
+            }
+        }
+
+        const ConcurrentVector* vector_;
+        size_t index_;
+        size_t end_;
+    };
+
+    Snapshot(const ConcurrentVector& vector, size_t size) noexcept
+        : vector_(&vector)
+        , size_(size) {
+    }
+
+    Iterator begin() const noexcept {
+        return Iterator(vector_, 0, size_);
+    }
+    Iterator end() const noexcept {
+        return Iterator(vector_, size_, size_);
+    }
+
+    // Число позиций в снимке, включая пропускаемые
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+private:
+    const ConcurrentVector* vector_;
+    size_t size_;
+};
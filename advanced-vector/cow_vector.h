@@ -0,0 +1,353 @@
+#pragma once
+
+#include "vector.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace detail {
+
+// Разделяемый буфер CowVector и CowSnapshot: вектор элементов и атомарный счётчик владельцев.
+// Блок выделяется аллокатором элементов, приведённым к типу блока
+template <typename VectorType>
+class CowBlock {
+    using BlockAllocator = typename std::allocator_traits<
+        typename VectorType::allocator_type>::template rebind_alloc<CowBlock>;
+    using BlockTraits = std::allocator_traits<BlockAllocator>;
+
+public:
+    explicit CowBlock(VectorType&& elements) noexcept
+        : elements_(std::move(elements)) {
+    }
+
+    // Блок с единственным владельцем
+    static CowBlock* Create(VectorType elements) {
+        BlockAllocator alloc(elements.GetAllocator());
+        CowBlock* const block = BlockTraits::allocate(alloc, 1);
+        BlockTraits::construct(alloc, block, std::move(elements));
+        return block;
+    }
+
+    // Новый владелец появляется только копированием существующего, поэтому порядок
+    // относительно других операций не нужен
+    void AddRef() noexcept {
+        refs_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Последний владелец разрушает блок. acq_rel упорядочивает все обращения к элементам
+    // других владельцев до разрушения
+    void Release() noexcept {
+        if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            BlockAllocator alloc(elements_.GetAllocator());
+            BlockTraits::destroy(alloc, this);
+            BlockTraits::deallocate(alloc, this, 1);
+        }
+    }
+
+    // Единственный ли владелец вызывающий. Если да, число владельцев не может вырасти без его участия
+    bool IsUnique() const noexcept {
+        return refs_.load(std::memory_order_acquire) == 1;
+    }
+
+    size_t UseCount() const noexcept {
+        return refs_.load(std::memory_order_relaxed);
+    }
+
+    VectorType& Elements() noexcept {
+        return elements_;
+    }
+
+    const VectorType& Elements() const noexcept {
+        return elements_;
+    }
+
+private:
+    std::atomic<size_t> refs_{1};
+    VectorType elements_;
+};
+
+// Элементы пустого CowVector, у которого ещё нет блока
+template <typename VectorType>
+const VectorType& EmptyCowElements() noexcept {
+    static const VectorType empty;
+    return empty;
+}
+
+}  // namespace detail
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+class CowVector;
+
+// Неизменяемый снимок содержимого CowVector. Держит буфер, бывший у вектора в момент снимка, и не видит
+// последующих изменений вектора: первое изменение переводит сам вектор на собственную копию.
+// Копирование снимка — увеличение счётчика владельцев
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth>
+class CowSnapshot {
+    using VectorType = Vector<T, Allocator, GrowthPolicy>;
+    using Block = detail::CowBlock<VectorType>;
+
+    friend class CowVector<T, Allocator, GrowthPolicy>;
+
+public:
+    using value_type = T;
+    using const_iterator = typename VectorType::const_iterator;
+
+    CowSnapshot() = default;
+
+    CowSnapshot(const CowSnapshot& other) noexcept
+        : block_(other.block_) {
+        if (block_ != nullptr) {
+            block_->AddRef();
+        }
+    }
+
+    CowSnapshot(CowSnapshot&& other) noexcept
+        : block_(std::exchange(other.block_, nullptr)) {
+    }
+
+    CowSnapshot& operator=(CowSnapshot rhs) noexcept {
+        std::swap(block_, rhs.block_);
+        return *this;
+    }
+
+    ~CowSnapshot() {
+        if (block_ != nullptr) {
+            block_->Release();
+        }
+    }
+
+    const VectorType& Elements() const noexcept {
+        return block_ != nullptr ? block_->Elements() : detail::EmptyCowElements<VectorType>();
+    }
+
+    const_iterator begin() const noexcept {
+        return Elements().begin();
+    }
+    const_iterator end() const noexcept {
+        return Elements().end();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return Elements()[index];
+    }
+
+    const T* Data() const noexcept {
+        return Elements().Data();
+    }
+
+    size_t Size() const noexcept {
+        return Elements().Size();
+    }
+
+    bool Empty() const noexcept {
+        return Size() == 0;
+    }
+
+    // Число владельцев буфера (векторов и снимков); 0 у пустого снимка
+    size_t UseCount() const noexcept {
+        return block_ != nullptr ? block_->UseCount() : 0;
+    }
+
+private:
+    explicit CowSnapshot(Block* block) noexcept
+        : block_(block) {
+        if (block_ != nullptr) {
+            block_->AddRef();
+        }
+    }
+
+    Block* block_ = nullptr;
+};
+
+// Вектор с копированием при записи. Копии разделяют один буфер, поэтому копирование — атомарное
+// увеличение счётчика владельцев за O(1), а элементы копируются только при первом изменении копии,
+// пока буфер разделён (Mutable и все изменяющие методы). Чтение идёт через константный интерфейс и
+// ничего не копирует. Разные копии можно читать и изменять из разных потоков; один объект CowVector,
+// как и Vector, одновременно из нескольких потоков не изменяют.
+// Ссылки и итераторы, полученные от изменяющих методов, указывают в собственный буфер вектора
+// и действительны до следующего копирования вектора или взятия снимка
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth>
+class CowVector {
+    using VectorType = Vector<T, Allocator, GrowthPolicy>;
+    using Block = detail::CowBlock<VectorType>;
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using vector_type = VectorType;
+    using iterator = typename VectorType::iterator;
+    using const_iterator = typename VectorType::const_iterator;
+
+    CowVector() = default;
+
+    explicit CowVector(size_t size)
+        : block_(Block::Create(VectorType(size))) {
+    }
+
+    // Забирает буфер elements
+    explicit CowVector(VectorType elements)
+        : block_(Block::Create(std::move(elements))) {
+    }
+
+    CowVector(const CowVector& other) noexcept
+        : block_(other.block_) {
+        if (block_ != nullptr) {
+            block_->AddRef();
+        }
+    }
+
+    CowVector(CowVector&& other) noexcept
+        : block_(std::exchange(other.block_, nullptr)) {
+    }
+
+    CowVector& operator=(CowVector rhs) noexcept {
+        Swap(rhs);
+        return *this;
+    }
+
+    ~CowVector() {
+        if (block_ != nullptr) {
+            block_->Release();
+        }
+    }
+
+    void Swap(CowVector& other) noexcept {
+        std::swap(block_, other.block_);
+    }
+
+    // Снимок текущего содержимого за O(1)
+    CowSnapshot<T, Allocator, GrowthPolicy> Snapshot() const noexcept {
+        return CowSnapshot<T, Allocator, GrowthPolicy>(block_);
+    }
+
+    // Число владельцев буфера (векторов и снимков); 0, пока у пустого вектора нет буфера
+    size_t UseCount() const noexcept {
+        return block_ != nullptr ? block_->UseCount() : 0;
+    }
+
+    const VectorType& Elements() const noexcept {
+        return block_ != nullptr ? block_->Elements() : detail::EmptyCowElements<VectorType>();
+    }
+
+    // Вектор, которым этот объект владеет единолично. Если буфер разделён, сначала копирует элементы;
+    // при исключении во время копирования вектор не изменяется
+    VectorType& Mutable() {
+        if (block_ == nullptr) {
+            block_ = Block::Create(VectorType());
+        } else if (!block_->IsUnique()) {
+            Block* const copy = Block::Create(VectorType(block_->Elements()));
+            block_->Release();
+            block_ = copy;
+        }
+        return block_->Elements();
+    }
+
+    const_iterator begin() const noexcept {
+        return Elements().begin();
+    }
+    const_iterator end() const noexcept {
+        return Elements().end();
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return Elements()[index];
+    }
+
+    T& operator[](size_t index) {
+        return Mutable()[index];
+    }
+
+    const T* Data() const noexcept {
+        return Elements().Data();
+    }
+
+    size_t Size() const noexcept {
+        return Elements().Size();
+    }
+
+    bool Empty() const noexcept {
+        return Size() == 0;
+    }
+
+    size_t Capacity() const noexcept {
+        return Elements().Capacity();
+    }
+
+    void Reserve(size_t new_capacity) {
+        Mutable().Reserve(new_capacity);
+    }
+
+    // Разделённый буфер не копируется: вектор просто перестаёт им владеть
+    void Clear() noexcept {
+        if (block_ != nullptr && !block_->IsUnique()) {
+            std::exchange(block_, nullptr)->Release();
+        } else if (block_ != nullptr) {
+            block_->Elements().Clear();
+        }
+    }
+
+    void Resize(size_t new_size) {
+        Mutable().Resize(new_size);
+    }
+
+    void Resize(size_t new_size, const T& value) {
+        Mutable().Resize(new_size, value);
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        return Mutable().EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    void PushBack(const T& value) {
+        Mutable().PushBack(value);
+    }
+
+    void PushBack(T&& value) {
+        Mutable().PushBack(std::move(value));
+    }
+
+    void PopBack() {
+        Mutable().PopBack();
+    }
+
+    // Позиции задаются итераторами константного интерфейса; они переводятся в индексы до копирования буфера
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args) {
+        const size_t index = pos - cbegin();
+        VectorType& elements = Mutable();
+        return elements.Emplace(elements.cbegin() + index, std::forward<Args>(args)...);
+    }
+
+    iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    iterator Erase(const_iterator pos) {
+        const size_t index = pos - cbegin();
+        VectorType& elements = Mutable();
+        return elements.Erase(elements.cbegin() + index);
+    }
+
+    iterator Erase(const_iterator first, const_iterator last) {
+        const size_t first_index = first - cbegin();
+        const size_t last_index = last - cbegin();
+        VectorType& elements = Mutable();
+        return elements.Erase(elements.cbegin() + first_index, elements.cbegin() + last_index);
+    }
+
+private:
+    Block* block_ = nullptr;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdlib>
+#include <memory>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+namespace detail {
+
+// Читаемое имя типа по имени из typeid(T).name(). В GCC и Clang имя раскодируется abi::__cxa_demangle,
+// в остальных компиляторах (и если раскодировать не удалось) остаётся исходным.
+// Не выбрасывает исключений, поэтому подходит для диагностик в noexcept-функциях
+class DemangledName {
+public:
+    explicit DemangledName(const char* name) noexcept
+        : name_(name) {
+#if defined(__GNUG__)
+        int status = 0;
+        demangled_.reset(abi::__cxa_demangle(name, nullptr, nullptr, &status));
+        if (status != 0) {
+            demangled_.reset();
+        }
+#endif
+    }
+
+    const char* Get() const noexcept {
+        return demangled_ ? demangled_.get() : name_;
+    }
+
+private:
+    struct Free {
+        void operator()(char* ptr) const noexcept {
+            std::free(ptr);
+        }
+    };
+
+    const char* name_;
+    std::unique_ptr<char, Free> demangled_;
+};
+
+}  // namespace detail
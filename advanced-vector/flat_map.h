@@ -0,0 +1,513 @@
+#pragma once
+
+#include "flat_set.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Упорядоченное отображение уникальных ключей в значения. Ключи и значения хранятся в двух отдельных
+// Vector одинаковой длины: двоичный поиск читает только плотный массив ключей, не затягивая в кеш значения,
+// а значение достаётся по найденному индексу. Элемент при обходе — пара ссылок (ключ, значение).
+// Вставка и удаление одного ключа сдвигают хвосты обоих массивов за O(n), пакетная вставка
+// (Insert диапазона) — одна сортировка новых пар и одно слияние. Итераторы инвалидируются любым
+// добавлением или удалением
+template <typename K, typename V, typename Compare = std::less<K>, typename KeyAllocator = std::allocator<K>,
+          typename ValueAllocator = std::allocator<V>>
+class FlatMap {
+    template <bool IsConst>
+    class BasicIterator;
+
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K, V>;
+    using key_compare = Compare;
+    using key_container_type = Vector<K, KeyAllocator>;
+    using mapped_container_type = Vector<V, ValueAllocator>;
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    FlatMap() = default;
+
+    explicit FlatMap(const Compare& comp)
+        : comp_(comp) {
+    }
+
+    // keys уже упорядочены и не содержат повторов, values[i] — значение ключа keys[i]
+    FlatMap(SortedUniqueT, key_container_type keys, mapped_container_type values, const Compare& comp = Compare())
+        : keys_(std::move(keys))
+        , values_(std::move(values))
+        , comp_(comp) {
+        VECTOR_CHECK(keys_.Size() == values_.Size(), "%zu keys for %zu values", keys_.Size(), values_.Size());
+        VECTOR_FULL_CHECK(std::adjacent_find(keys_.begin(), keys_.end(), [this](const K& lhs, const K& rhs) {
+                              return !comp_(lhs, rhs);
+                          }) == keys_.end(),
+                          "keys are not sorted and unique");
+    }
+
+    // Строит отображение из диапазона пар (ключ, значение) одной сортировкой. Из пар с одинаковыми
+    // ключами остаётся первая
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    FlatMap(InputIt first, InputIt last, const Compare& comp = Compare())
+        : comp_(comp) {
+        Insert(first, last);
+    }
+
+    FlatMap(std::initializer_list<value_type> items, const Compare& comp = Compare())
+        : FlatMap(items.begin(), items.end(), comp) {
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+    iterator end() noexcept {
+        return iterator(this, Size());
+    }
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(this, Size());
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    size_t Size() const noexcept {
+        return keys_.Size();
+    }
+
+    bool Empty() const noexcept {
+        return keys_.Size() == 0;
+    }
+
+    void Reserve(size_t new_capacity) {
+        keys_.Reserve(new_capacity);
+        values_.Reserve(new_capacity);
+    }
+
+    void ShrinkToFit() {
+        keys_.ShrinkToFit();
+        values_.ShrinkToFit();
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+        values_.Clear();
+    }
+
+    void Swap(FlatMap& other) noexcept {
+        keys_.Swap(other.keys_);
+        values_.Swap(other.values_);
+        std::swap(comp_, other.comp_);
+    }
+
+    const Compare& KeyComp() const noexcept {
+        return comp_;
+    }
+
+    // Упорядоченные ключи и соответствующие им значения
+    const key_container_type& Keys() const noexcept {
+        return keys_;
+    }
+
+    const mapped_container_type& Values() const noexcept {
+        return values_;
+    }
+
+    iterator LowerBound(const K& key) {
+        return iterator(this, LowerBoundIndex(key));
+    }
+
+    const_iterator LowerBound(const K& key) const {
+        return const_iterator(this, LowerBoundIndex(key));
+    }
+
+    iterator UpperBound(const K& key) {
+        return iterator(this, UpperBoundIndex(key));
+    }
+
+    const_iterator UpperBound(const K& key) const {
+        return const_iterator(this, UpperBoundIndex(key));
+    }
+
+    iterator Find(const K& key) {
+        return iterator(this, FindIndex(key));
+    }
+
+    const_iterator Find(const K& key) const {
+        return const_iterator(this, FindIndex(key));
+    }
+
+    bool Contains(const K& key) const {
+        return FindIndex(key) != Size();
+    }
+
+    size_t Count(const K& key) const {
+        return Contains(key) ? 1 : 0;
+    }
+
+    // Значение ключа key. Если ключа нет, выбрасывает std::out_of_range
+    V& At(const K& key) {
+        return values_[CheckedIndex(key)];
+    }
+
+    const V& At(const K& key) const {
+        return values_[CheckedIndex(key)];
+    }
+
+    // Значение ключа key; при отсутствии ключа вставляет значение по умолчанию
+    V& operator[](const K& key) {
+        return values_[TryEmplaceIndex(key).first];
+    }
+
+    V& operator[](K&& key) {
+        return values_[TryEmplaceIndex(std::move(key)).first];
+    }
+
+    // Если ключа нет, вставляет его со значением, построенным из args. Возвращает позицию ключа и признак вставки
+    template <typename... Args>
+    std::pair<iterator, bool> TryEmplace(const K& key, Args&&... args) {
+        return ToIterator(TryEmplaceIndex(key, std::forward<Args>(args)...));
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> TryEmplace(K&& key, Args&&... args) {
+        return ToIterator(TryEmplaceIndex(std::move(key), std::forward<Args>(args)...));
+    }
+
+    std::pair<iterator, bool> Insert(const value_type& item) {
+        return TryEmplace(item.first, item.second);
+    }
+
+    std::pair<iterator, bool> Insert(value_type&& item) {
+        return TryEmplace(std::move(item.first), std::move(item.second));
+    }
+
+    // Вставляет ключ со значением value или присваивает value значению имеющегося ключа
+    template <typename M>
+    std::pair<iterator, bool> InsertOrAssign(const K& key, M&& value) {
+        const auto [index, inserted] = TryEmplaceIndex(key, std::forward<M>(value));
+        if (!inserted) {
+            values_[index] = std::forward<M>(value);
+        }
+        return {iterator(this, index), inserted};
+    }
+
+    // Добавляет пары диапазона, которых ещё нет в отображении (из пар с одинаковыми ключами остаётся первая).
+    // Новые пары собираются во временный Vector пар и упорядочиваются отдельно. Если они идут целиком после
+    // имеющихся, они дописываются в оба массива, иначе сливаются с имеющимися за один проход в новые массивы
+    // ключей и значений: в отличие от FlatSet слияние не выполняется на месте, потому что ключи и значения
+    // лежат в разных массивах, и на время вставки нужна память под новые массивы и временные пары.
+    // Память выделяется до переноса элементов, и её нехватка оставляет отображение нетронутым. Если
+    // перемещение выбросит исключение при дозаписи, дописанные пары удаляются; если сравнение или
+    // перемещение выбросит исключение во время слияния, отображение очищается
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    void Insert(InputIt first, InputIt last) {
+        Vector<value_type> items;
+        items.Assign(first, last);
+        value_type* const items_end = detail::SortUnique(
+            items.Data(), items.Data() + items.Size(), comp_, [](const value_type& item) -> const K& {
+                return item.first;
+            });
+        const size_t count = items_end - items.Data();
+        if (count == 0) {
+            return;
+        }
+        const size_t old_size = Size();
+        if (Empty() || comp_(keys_[old_size - 1], items[0].first)) {
+            // новые ключи идут целиком после имеющихся: достаточно дописать оба массива
+            Reserve(old_size + count);
+            try {
+                for (size_t i = 0; i < count; ++i) {
+                    keys_.EmplaceBack(std::move(items[i].first));
+                    values_.EmplaceBack(std::move(items[i].second));
+                }
+            }
+            catch (...) {
+                keys_.Erase(keys_.cbegin() + old_size, keys_.cend());
+                values_.Erase(values_.cbegin() + old_size, values_.cend());
+                throw;
+            }
+            return;
+        }
+        key_container_type keys(keys_.GetAllocator());
+        mapped_container_type values(values_.GetAllocator());
+        keys.Reserve(old_size + count);
+        values.Reserve(old_size + count);
+        try {
+            MergeItems(items.Data(), count, keys, values);
+        }
+        catch (...) {
+            Clear();
+            throw;
+        }
+        keys_.Swap(keys);
+        values_.Swap(values);
+    }
+
+    void Insert(std::initializer_list<value_type> items) {
+        Insert(items.begin(), items.end());
+    }
+
+    // Удаляет key, если он есть. Возвращает число удалённых ключей
+    size_t Erase(const K& key) {
+        const size_t index = FindIndex(key);
+        if (index == Size()) {
+            return 0;
+        }
+        EraseIndex(index);
+        return 1;
+    }
+
+    iterator Erase(const_iterator pos) {
+        VECTOR_CHECK(pos.Index() < Size(), "position %zu outside [0, %zu)", pos.Index(), Size());
+        EraseIndex(pos.Index());
+        return iterator(this, pos.Index());
+    }
+
+    // Удаляет пары, для которых pred(ключ, значение) истинен. Возвращает их число
+    template <typename Predicate>
+    friend size_t EraseIf(FlatMap& map, Predicate pred) {
+        size_t kept = 0;
+        const size_t size = map.Size();
+        for (size_t i = 0; i < size; ++i) {
+            if (!pred(std::as_const(map.keys_[i]), map.values_[i])) {
+                if (kept != i) {
+                    map.keys_[kept] = std::move(map.keys_[i]);
+                    map.values_[kept] = std::move(map.values_[i]);
+                }
+                ++kept;
+            }
+        }
+        map.keys_.Erase(map.keys_.cbegin() + kept, map.keys_.cend());
+        map.values_.Erase(map.values_.cbegin() + kept, map.values_.cend());
+        return size - kept;
+    }
+
+    friend bool operator==(const FlatMap& lhs, const FlatMap& rhs) {
+        return std::equal(lhs.keys_.begin(), lhs.keys_.end(), rhs.keys_.begin(), rhs.keys_.end())
+            && std::equal(lhs.values_.begin(), lhs.values_.end(), rhs.values_.begin());
+    }
+
+    friend bool operator!=(const FlatMap& lhs, const FlatMap& rhs) {
+        return !(lhs == rhs);
+    }
+
+private:
+    size_t LowerBoundIndex(const K& key) const {
+        return detail::BranchlessLowerBound(keys_.Data(), keys_.Size(), key, comp_) - keys_.Data();
+    }
+
+    size_t UpperBoundIndex(const K& key) const {
+        return detail::BranchlessUpperBound(keys_.Data(), keys_.Size(), key, comp_) - keys_.Data();
+    }
+
+    // Индекс ключа key или Size(), если его нет
+    size_t FindIndex(const K& key) const {
+        const size_t index = LowerBoundIndex(key);
+        return index != Size() && !comp_(key, keys_[index]) ? index : Size();
+    }
+
+    size_t CheckedIndex(const K& key) const {
+        const size_t index = FindIndex(key);
+        if (index == Size()) {
+            throw std::out_of_range("FlatMap::At: key not found");
+        }
+        return index;
+    }
+
+    std::pair<iterator, bool> ToIterator(std::pair<size_t, bool> result) noexcept {
+        return {iterator(this, result.first), result.second};
+    }
+
+    // Ключ вставляется первым; если построение значения выбросит исключение, ключ удаляется
+    template <typename Key, typename... Args>
+    std::pair<size_t, bool> TryEmplaceIndex(Key&& key, Args&&... args) {
+        const size_t index = LowerBoundIndex(key);
+        if (index != Size() && !comp_(key, keys_[index])) {
+            return {index, false};
+        }
+        keys_.Emplace(keys_.cbegin() + index, std::forward<Key>(key));
+        try {
+            values_.Emplace(values_.cbegin() + index, std::forward<Args>(args)...);
+        }
+        catch (...) {
+            keys_.Erase(keys_.cbegin() + index);
+            throw;
+        }
+        return {index, true};
+    }
+
+    void EraseIndex(size_t index) {
+        keys_.Erase(keys_.cbegin() + index);
+        values_.Erase(values_.cbegin() + index);
+    }
+
+    // Сливает имеющиеся пары с count упорядоченными парами items в пустые массивы keys и values,
+    // вместимости которых хватает на все пары. Пары, ключи которых уже есть, пропускаются
+    void MergeItems(value_type* items, size_t count, key_container_type& keys, mapped_container_type& values) {
+        size_t i = 0;
+        size_t j = 0;
+        while (i != Size() && j != count) {
+            if (comp_(items[j].first, keys_[i])) {
+                keys.EmplaceBack(std::move(items[j].first));
+                values.EmplaceBack(std::move(items[j].second));
+                ++j;
+            } else {
+                if (!comp_(keys_[i], items[j].first)) {
+                    ++j;
+                }
+                keys.EmplaceBack(std::move(keys_[i]));
+                values.EmplaceBack(std::move(values_[i]));
+                ++i;
+            }
+        }
+        for (; i != Size(); ++i) {
+            keys.EmplaceBack(std::move(keys_[i]));
+            values.EmplaceBack(std::move(values_[i]));
+        }
+        for (; j != count; ++j) {
+            keys.EmplaceBack(std::move(items[j].first));
+            values.EmplaceBack(std::move(items[j].second));
+        }
+    }
+
+    key_container_type keys_;
+    mapped_container_type values_;
+    [[no_unique_address]] Compare comp_;
+};
+
+// Итератор по парам (ключ, значение) с произвольным доступом. Это итератор-заместитель: reference —
+// не value_type&, а временная пара ссылок std::pair<const K&, V&>, поэтому работают структурные привязки
+// и it->second, но ссылку на пару сохранить нельзя. Ключи неизменяемы, так что алгоритмы, переставляющие
+// элементы (std::sort и подобные), к нему не применяются. Итераторы разных отображений не равны
+template <typename K, typename V, typename Compare, typename KeyAllocator, typename ValueAllocator>
+template <bool IsConst>
+class FlatMap<K, V, Compare, KeyAllocator, ValueAllocator>::BasicIterator {
+    using MapPtr = std::conditional_t<IsConst, const FlatMap*, FlatMap*>;
+
+    friend class BasicIterator<!IsConst>;
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::pair<K, V>;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::pair<const K&, std::conditional_t<IsConst, const V&, V&>>;
+
+    // Хранит пару ссылок, на которую указывает operator->
+    class pointer {
+    public:
+        explicit pointer(reference ref) noexcept
+            : ref_(ref) {
+        }
+        const reference* operator->() const noexcept {
+            return &ref_;
+        }
+
+    private:
+        reference ref_;
+    };
+
+    BasicIterator() = default;
+
+    BasicIterator(MapPtr map, size_t index) noexcept
+        : map_(map)
+        , index_(index) {
+    }
+
+    // iterator приводится к const_iterator
+    template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+    BasicIterator(const BasicIterator<OtherConst>& other) noexcept
+        : map_(other.map_)
+        , index_(other.index_) {
+    }
+
+    reference operator*() const noexcept {
+        VECTOR_CHECK(index_ < map_->Size(), "index %zu out of range for size %zu", index_, map_->Size());
+        return reference(map_->keys_.Data()[index_], map_->values_.Data()[index_]);
+    }
+    pointer operator->() const noexcept {
+        return pointer(**this);
+    }
+    reference operator[](difference_type offset) const noexcept {
+        return *(*this + offset);
+    }
+
+    // Индекс пары в отображении
+    size_t Index() const noexcept {
+        return index_;
+    }
+
+    BasicIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+    BasicIterator operator++(int) noexcept {
+        BasicIterator result = *this;
+        ++index_;
+        return result;
+    }
+    BasicIterator& operator--() noexcept {
+        --index_;
+        return *this;
+    }
+    BasicIterator operator--(int) noexcept {
+        BasicIterator result = *this;
+        --index_;
+        return result;
+    }
+    BasicIterator& operator+=(difference_type offset) noexcept {
+        index_ += offset;
+        return *this;
+    }
+    BasicIterator& operator-=(difference_type offset) noexcept {
+        index_ -= offset;
+        return *this;
+    }
+    friend BasicIterator operator+(BasicIterator it, difference_type offset) noexcept {
+        return it += offset;
+    }
+    friend BasicIterator operator+(difference_type offset, BasicIterator it) noexcept {
+        return it += offset;
+    }
+    friend BasicIterator operator-(BasicIterator it, difference_type offset) noexcept {
+        return it -= offset;
+    }
+    friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+    friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return lhs.map_ == rhs.map_ && lhs.index_ == rhs.index_;
+    }
+    friend bool operator!=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+    friend bool operator<(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return lhs.index_ < rhs.index_;
+    }
+    friend bool operator>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return rhs < lhs;
+    }
+    friend bool operator<=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return !(rhs < lhs);
+    }
+    friend bool operator>=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return !(lhs < rhs);
+    }
+
+private:
+    MapPtr map_ = nullptr;
+    size_t index_ = 0;
+};
@@ -0,0 +1,305 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+
+// Признак конструкторов FlatSet и FlatMap из уже упорядоченных ключей без повторов: сортировка пропускается
+struct SortedUniqueT {
+    explicit SortedUniqueT() = default;
+};
+
+inline constexpr SortedUniqueT SORTED_UNIQUE{};
+
+namespace detail {
+
+// Первый элемент [first, first + n), для которого pred ложен (элементы, для которых он истинен, идут первыми).
+// Вместо ветвления по результату сравнения начало диапазона сдвигается условным выбором, который компилятор
+// превращает в cmov, поэтому цена поиска не зависит от предсказания переходов. Обе возможные середины
+// следующего шага запрашиваются заранее, чтобы промахи кеша на больших массивах перекрывались
+template <typename K, typename Predicate>
+const K* BranchlessPartitionPoint(const K* first, size_t n, Predicate pred) {
+    const K* base = first;
+    while (n > 0) {
+        const size_t half = n / 2;
+#if defined(__GNUC__)
+        __builtin_prefetch(base + half / 2);
+        __builtin_prefetch(base + (n - half) + half / 2);
+#endif
+        base = pred(base[half]) ? base + (n - half) : base;
+        n = half;
+    }
+    return base;
+}
+
+template <typename K, typename Compare>
+const K* BranchlessLowerBound(const K* first, size_t n, const K& key, const Compare& comp) {
+    return BranchlessPartitionPoint(first, n, [&](const K& element) {
+        return comp(element, key);
+    });
+}
+
+template <typename K, typename Compare>
+const K* BranchlessUpperBound(const K* first, size_t n, const K& key, const Compare& comp) {
+    return BranchlessPartitionPoint(first, n, [&](const K& element) {
+        return !comp(key, element);
+    });
+}
+
+// Упорядочивает [first, last) и удаляет повторы, оставляя первое вхождение каждого ключа.
+// get_key выделяет ключ из элемента. Возвращает новый конец диапазона
+template <typename It, typename Compare, typename GetKey>
+It SortUnique(It first, It last, const Compare& comp, GetKey get_key) {
+    std::stable_sort(first, last, [&](const auto& lhs, const auto& rhs) {
+        return comp(get_key(lhs), get_key(rhs));
+    });
+    // в упорядоченном диапазоне соседние элементы эквивалентны, если левый не меньше правого
+    return std::unique(first, last, [&](const auto& lhs, const auto& rhs) {
+        return !comp(get_key(lhs), get_key(rhs));
+    });
+}
+
+struct Identity {
+    template <typename T>
+    const T& operator()(const T& value) const noexcept {
+        return value;
+    }
+};
+
+}  // namespace detail
+
+// Упорядоченное множество уникальных ключей в одном Vector. Поиск — безветвленный двоичный поиск по
+// непрерывному массиву, обход — последовательное чтение памяти; вставка и удаление одного ключа сдвигают
+// хвост за O(n), а пакетная вставка (Insert диапазона) обходится одной сортировкой новых ключей и одним
+// слиянием. Итераторы константные и инвалидируются любым изменением множества
+template <typename K, typename Compare = std::less<K>, typename Allocator = std::allocator<K>>
+class FlatSet {
+public:
+    using key_type = K;
+    using value_type = K;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+    using container_type = Vector<K, Allocator>;
+    using iterator = typename container_type::const_iterator;
+    using const_iterator = iterator;
+
+    FlatSet() = default;
+
+    explicit FlatSet(const Compare& comp, const Allocator& alloc = Allocator())
+        : keys_(alloc)
+        , comp_(comp) {
+    }
+
+    // Забирает буфер keys, упорядочивает его и удаляет повторы
+    explicit FlatSet(container_type keys, const Compare& comp = Compare())
+        : keys_(std::move(keys))
+        , comp_(comp) {
+        SortKeys();
+    }
+
+    // keys уже упорядочены и не содержат повторов
+    FlatSet(SortedUniqueT, container_type keys, const Compare& comp = Compare())
+        : keys_(std::move(keys))
+        , comp_(comp) {
+        VECTOR_FULL_CHECK(IsSortedUnique(), "keys are not sorted and unique");
+    }
+
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    FlatSet(InputIt first, InputIt last, const Compare& comp = Compare())
+        : comp_(comp) {
+        keys_.Assign(first, last);
+        SortKeys();
+    }
+
+    FlatSet(std::initializer_list<K> keys, const Compare& comp = Compare())
+        : FlatSet(keys.begin(), keys.end(), comp) {
+    }
+
+    const_iterator begin() const noexcept {
+        return keys_.begin();
+    }
+    const_iterator end() const noexcept {
+        return keys_.end();
+    }
+    const_iterator cbegin() const noexcept {
+        return keys_.cbegin();
+    }
+    const_iterator cend() const noexcept {
+        return keys_.cend();
+    }
+
+    size_t Size() const noexcept {
+        return keys_.Size();
+    }
+
+    bool Empty() const noexcept {
+        return keys_.Size() == 0;
+    }
+
+    size_t Capacity() const noexcept {
+        return keys_.Capacity();
+    }
+
+    void Reserve(size_t new_capacity) {
+        keys_.Reserve(new_capacity);
+    }
+
+    void ShrinkToFit() {
+        keys_.ShrinkToFit();
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+    }
+
+    void Swap(FlatSet& other) noexcept {
+        keys_.Swap(other.keys_);
+        std::swap(comp_, other.comp_);
+    }
+
+    const Compare& KeyComp() const noexcept {
+        return comp_;
+    }
+
+    // Упорядоченные ключи
+    const container_type& Keys() const noexcept {
+        return keys_;
+    }
+
+    // Забирает буфер ключей, оставляя множество пустым
+    container_type Extract() noexcept {
+        return std::move(keys_);
+    }
+
+    const_iterator LowerBound(const K& key) const {
+        return At(detail::BranchlessLowerBound(keys_.Data(), keys_.Size(), key, comp_));
+    }
+
+    const_iterator UpperBound(const K& key) const {
+        return At(detail::BranchlessUpperBound(keys_.Data(), keys_.Size(), key, comp_));
+    }
+
+    const_iterator Find(const K& key) const {
+        const K* const pos = detail::BranchlessLowerBound(keys_.Data(), keys_.Size(), key, comp_);
+        return IsKeyAt(pos, key) ? At(pos) : end();
+    }
+
+    bool Contains(const K& key) const {
+        return IsKeyAt(detail::BranchlessLowerBound(keys_.Data(), keys_.Size(), key, comp_), key);
+    }
+
+    size_t Count(const K& key) const {
+        return Contains(key) ? 1 : 0;
+    }
+
+    // Вставляет key, если его нет. Возвращает позицию ключа и признак вставки
+    std::pair<const_iterator, bool> Insert(const K& key) {
+        return InsertUnique(key);
+    }
+
+    std::pair<const_iterator, bool> Insert(K&& key) {
+        return InsertUnique(std::move(key));
+    }
+
+    // Добавляет ключи диапазона: они дописываются в конец, упорядочиваются отдельно от имеющихся и
+    // сливаются с ними одним std::inplace_merge — O(n + m log m) вместо O(n * m) при поштучной вставке.
+    // Ключи, которые уже есть в множестве, не добавляются. Если сравнение или перемещение ключей
+    // выбросит исключение во время слияния, множество очищается
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    void Insert(InputIt first, InputIt last) {
+        const size_t old_size = keys_.Size();
+        keys_.Append(first, last);
+        try {
+            K* const data = keys_.Data();
+            K* const middle = data + old_size;
+            K* new_end = detail::SortUnique(middle, data + keys_.Size(), comp_, detail::Identity{});
+            // слияние нужно, только если новые ключи не идут целиком после имеющихся (дозапись по возрастанию)
+            if (old_size != 0 && middle != new_end && !comp_(middle[-1], *middle)) {
+                std::inplace_merge(data, middle, new_end, comp_);
+                new_end = std::unique(data, new_end, [this](const K& lhs, const K& rhs) {
+                    return !comp_(lhs, rhs);
+                });
+            }
+            keys_.Erase(keys_.cbegin() + (new_end - data), keys_.cend());
+        }
+        catch (...) {
+            keys_.Clear();
+            throw;
+        }
+    }
+
+    void Insert(std::initializer_list<K> keys) {
+        Insert(keys.begin(), keys.end());
+    }
+
+    // Удаляет key, если он есть. Возвращает число удалённых ключей
+    size_t Erase(const K& key) {
+        const const_iterator pos = Find(key);
+        if (pos == end()) {
+            return 0;
+        }
+        keys_.Erase(pos);
+        return 1;
+    }
+
+    const_iterator Erase(const_iterator pos) {
+        return keys_.Erase(pos);
+    }
+
+    const_iterator Erase(const_iterator first, const_iterator last) {
+        return keys_.Erase(first, last);
+    }
+
+    template <typename Predicate>
+    friend size_t EraseIf(FlatSet& set, Predicate pred) {
+        return EraseIf(set.keys_, pred);
+    }
+
+    friend bool operator==(const FlatSet& lhs, const FlatSet& rhs) {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+    friend bool operator!=(const FlatSet& lhs, const FlatSet& rhs) {
+        return !(lhs == rhs);
+    }
+
+private:
+    const_iterator At(const K* pos) const noexcept {
+        return keys_.cbegin() + (pos - keys_.Data());
+    }
+
+    bool IsKeyAt(const K* pos, const K& key) const {
+        return pos != keys_.Data() + keys_.Size() && !comp_(key, *pos);
+    }
+
+    bool IsSortedUnique() const {
+        return std::adjacent_find(keys_.begin(), keys_.end(), [this](const K& lhs, const K& rhs) {
+                   return !comp_(lhs, rhs);
+               }) == keys_.end();
+    }
+
+    void SortKeys() {
+        K* const data = keys_.Data();
+        K* const new_end = detail::SortUnique(data, data + keys_.Size(), comp_, detail::Identity{});
+        keys_.Erase(keys_.cbegin() + (new_end - data), keys_.cend());
+    }
+
+    template <typename Key>
+    std::pair<const_iterator, bool> InsertUnique(Key&& key) {
+        const K* const pos = detail::BranchlessLowerBound(keys_.Data(), keys_.Size(), key, comp_);
+        if (IsKeyAt(pos, key)) {
+            return {At(pos), false};
+        }
+        const size_t index = pos - keys_.Data();
+        keys_.Emplace(keys_.cbegin() + index, std::forward<Key>(key));
+        return {keys_.cbegin() + index, true};
+    }
+
+    container_type keys_;
+    [[no_unique_address]] Compare comp_;
+};
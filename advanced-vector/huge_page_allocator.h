@@ -0,0 +1,179 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#include <sys/mman.h>
+
+// Аллокатор для больших буферов. Блоки от MapThresholdBytes байт выделяются отдельным отображением
+// анонимной памяти (mmap), округлённым до размера большой страницы, и помечаются для прозрачных
+// больших страниц (MADV_HUGEPAGE), что уменьшает число промахов TLB. Меньшие блоки берутся из malloc.
+// Поддерживает reallocate: Vector с тривиально перемещаемыми элементами растёт через mremap или realloc,
+// то есть расширяет блок на месте или переносит его страницы без копирования и без одновременного
+// удержания старого и нового буферов. Перенесённое отображение остаётся выровненным по большой странице
+template <typename T, size_t MapThresholdBytes = 2 * 1024 * 1024>
+class HugePageAllocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned types are not supported");
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = HugePageAllocator<U, MapThresholdBytes>;
+    };
+
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+    static constexpr size_t MAP_THRESHOLD = MapThresholdBytes;
+
+    HugePageAllocator() = default;
+
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U, MapThresholdBytes>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        const size_t bytes = n * sizeof(T);
+        void* ptr = IsMapped(bytes) ? Map(bytes) : std::malloc(bytes);
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+        if (IsMapped(bytes)) {
+            ::munmap(ptr, MappedLength(bytes));
+        } else {
+            std::free(ptr);
+        }
+    }
+
+    // Изменяет размер блока ptr с old_n до new_n элементов, сохраняя первые min(old_n, new_n) элементов
+    // побайтово. Блок может переместиться. При неудаче выбрасывает std::bad_alloc, оставляя ptr нетронутым
+    T* reallocate(T* ptr, size_t old_n, size_t new_n) {
+        if (new_n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        const size_t old_bytes = old_n * sizeof(T);
+        const size_t new_bytes = new_n * sizeof(T);
+        if (!IsMapped(old_bytes) && !IsMapped(new_bytes)) {
+            void* result = std::realloc(ptr, new_bytes);
+            if (result == nullptr) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(result);
+        }
+#ifdef __linux__
+        if (IsMapped(old_bytes) && IsMapped(new_bytes)) {
+            const size_t old_length = MappedLength(old_bytes);
+            const size_t new_length = MappedLength(new_bytes);
+            if (old_length == new_length) {
+                return ptr;
+            }
+            // на месте адрес, а с ним и выравнивание, сохраняется; уменьшение на месте удаётся всегда
+            void* result = ::mremap(ptr, old_length, new_length, 0);
+            if (result == MAP_FAILED) {
+                // за блоком нет свободных адресов: страницы переносятся в заранее занятую выровненную
+                // область, иначе ядро выбрало бы адрес, выровненный только по обычной странице
+                void* const target = MapAligned(new_length, PROT_NONE);
+                if (target == nullptr) {
+                    throw std::bad_alloc();
+                }
+                result = ::mremap(ptr, old_length, new_length, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+                if (result == MAP_FAILED) {
+                    ::munmap(target, new_length);
+                    throw std::bad_alloc();
+                }
+            }
+            AdviseHugePages(result, new_length);
+            return static_cast<T*>(result);
+        }
+#endif
+        // блок переходит между malloc и отображением: копирование неизбежно
+        T* result = allocate(new_n);
+        std::memcpy(static_cast<void*>(result), static_cast<const void*>(ptr), std::min(old_bytes, new_bytes));
+        deallocate(ptr, old_n);
+        return result;
+    }
+
+    template <typename U>
+    bool operator==(const HugePageAllocator<U, MapThresholdBytes>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const HugePageAllocator<U, MapThresholdBytes>&) const noexcept {
+        return false;
+    }
+
+private:
+    static bool IsMapped(size_t bytes) noexcept {
+        return bytes >= MAP_THRESHOLD && bytes != 0;
+    }
+
+    static size_t MappedLength(size_t bytes) noexcept {
+        return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    }
+
+    static void AdviseHugePages([[maybe_unused]] void* ptr, [[maybe_unused]] size_t length) noexcept {
+#ifdef MADV_HUGEPAGE
+        // подсказка необязательна: без поддержки THP память просто останется на обычных страницах
+        ::madvise(ptr, length, MADV_HUGEPAGE);
+#endif
+    }
+
+    // Отображает блок, выровненный по границе большой страницы, чтобы ядро могло целиком
+    // покрыть его большими страницами. Возвращает nullptr при нехватке памяти
+    static void* Map(size_t bytes) noexcept {
+        const size_t length = MappedLength(bytes);
+        if (length < bytes) {
+            return nullptr;
+        }
+        void* const ptr = MapAligned(length, PROT_READ | PROT_WRITE);
+        if (ptr != nullptr) {
+            AdviseHugePages(ptr, length);
+        }
+        return ptr;
+    }
+
+    // Отображает length байт (кратно HUGE_PAGE_SIZE) анонимной памяти с защитой prot, начиная с границы
+    // большой страницы. Возвращает nullptr при нехватке памяти
+    static void* MapAligned(size_t length, int prot) noexcept {
+        if (length > std::numeric_limits<size_t>::max() - HUGE_PAGE_SIZE) {
+            return nullptr;
+        }
+        void* raw = ::mmap(nullptr, length + HUGE_PAGE_SIZE, prot, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            return nullptr;
+        }
+        // обрезаем невыровненные начало и конец
+        char* const begin = static_cast<char*>(raw);
+        const size_t misalignment = reinterpret_cast<std::uintptr_t>(begin) % HUGE_PAGE_SIZE;
+        const size_t head = misalignment == 0 ? 0 : HUGE_PAGE_SIZE - misalignment;
+        if (head != 0) {
+            ::munmap(begin, head);
+        }
+        if (HUGE_PAGE_SIZE - head != 0) {
+            ::munmap(begin + head + length, HUGE_PAGE_SIZE - head);
+        }
+        return begin + head;
+    }
+};
+
+// Вектор для больших тривиально перемещаемых элементов: рост без копирования и на больших страницах
+template <typename T, typename GrowthPolicy = DoublingGrowth>
+using HugePageVector = Vector<T, HugePageAllocator<T>, GrowthPolicy>;
@@ -0,0 +1,464 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+// Элементы, с которыми InplaceVector работает обычными присваиваниями в массиве T[N]
+template <typename T>
+inline constexpr bool is_inplace_trivial_v =
+    std::is_trivially_copyable_v<T> && std::is_trivially_default_constructible_v<T>;
+
+// Хранилище InplaceVector для тривиальных T: массив T[N], с которым все операции constexpr.
+// Копирование и перемещение тривиальны, поэтому InplaceVector тривиально копируем.
+// В C++20 массив обнуляется только при вычислении на этапе компиляции, во время выполнения он остаётся
+// неинициализированным; в C++17 constexpr-конструктор обязан инициализировать массив, и каждый
+// созданный вектор обнуляет все N ячеек
+template <typename T, size_t N>
+class InplaceArray {
+protected:
+#if VECTOR_HAS_CONSTEXPR
+    constexpr InplaceArray() noexcept {
+        if (IsConstantEvaluated()) {
+            for (T& element : elements_) {
+                element = T();
+            }
+        }
+    }
+#endif
+
+    constexpr T* Data() noexcept {
+        return elements_;
+    }
+    constexpr const T* Data() const noexcept {
+        return elements_;
+    }
+
+#if VECTOR_HAS_CONSTEXPR
+    T elements_[N == 0 ? 1 : N];
+#else
+    T elements_[N == 0 ? 1 : N] = {};
+#endif
+    size_t size_ = 0;
+};
+
+// Сырая память, в которой живут первые size_ элементов. Специальные функции по умолчанию копируют
+// байты буфера и размер, что годится для тривиально копируемых T (в том числе с нетривиальным
+// конструктором по умолчанию): такой InplaceVector тоже тривиально копируем, а исходный вектор после
+// перемещения сохраняет свои элементы
+template <typename T, size_t N>
+class InplaceBuffer {
+protected:
+    T* Data() noexcept {
+        return std::launder(reinterpret_cast<T*>(buffer_));
+    }
+    const T* Data() const noexcept {
+        return std::launder(reinterpret_cast<const T*>(buffer_));
+    }
+
+    alignas(T) unsigned char buffer_[(N == 0 ? 1 : N) * sizeof(T)];
+    size_t size_ = 0;
+};
+
+// Сырая память для нетривиально копируемых T: элементы копируются, перемещаются и разрушаются
+// поэлементно. После перемещения исходный вектор пуст
+template <typename T, size_t N>
+class InplaceObjectBuffer : protected InplaceBuffer<T, N> {
+protected:
+    using InplaceBuffer<T, N>::Data;
+    using InplaceBuffer<T, N>::size_;
+
+    InplaceObjectBuffer() noexcept {
+    }
+
+    InplaceObjectBuffer(const InplaceObjectBuffer& other) {
+        std::uninitialized_copy_n(other.Data(), other.size_, Data());
+        size_ = other.size_;
+    }
+
+    InplaceObjectBuffer(InplaceObjectBuffer&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        detail::UninitializedRelocateN(other.Data(), other.size_, Data());
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    InplaceObjectBuffer& operator=(const InplaceObjectBuffer& rhs) {
+        if (this != &rhs) {
+            detail::AssignInPlace(Data(), size_, rhs.Data(), rhs.size_);
+        }
+        return *this;
+    }
+
+    InplaceObjectBuffer& operator=(InplaceObjectBuffer&& rhs) noexcept(std::is_nothrow_move_assignable_v<T>
+                                                                       && std::is_nothrow_move_constructible_v<T>) {
+        if (this != &rhs) {
+            detail::AssignInPlace(Data(), size_, std::make_move_iterator(rhs.Data()), rhs.size_);
+            std::destroy_n(rhs.Data(), rhs.size_);
+            rhs.size_ = 0;
+        }
+        return *this;
+    }
+
+    ~InplaceObjectBuffer() {
+        std::destroy_n(Data(), size_);
+    }
+};
+
+// Хранилище InplaceVector: массив для тривиальных T, сырая память с тривиальными специальными функциями
+// для остальных тривиально копируемых T и сырая память с поэлементными операциями для прочих
+template <typename T, size_t N>
+using InplaceStorage =
+    std::conditional_t<is_inplace_trivial_v<T>, InplaceArray<T, N>,
+                       std::conditional_t<std::is_trivially_copyable_v<T>, InplaceBuffer<T, N>,
+                                          InplaceObjectBuffer<T, N>>>;
+
+}  // namespace detail
+
+// Вектор вместимостью не более N элементов, хранящий их внутри объекта. Не обращается к куче и не
+// перевыделяет буфер, поэтому в нём нет ветки роста: добавление в заполненный вектор выбрасывает
+// std::length_error, а TryEmplaceBack возвращает nullptr. Интерфейс повторяет Vector. Элементы
+// нетривиальных типов обрабатываются общими с Vector функциями detail::*InPlace; для тривиальных T
+// (тривиально копируемых и конструируемых по умолчанию) все операции constexpr. InplaceVector
+// тривиально копируем, если тривиально копируем T. Создание вектора не инициализирует ячейки, кроме
+// сборки в C++17 для тривиальных T, где все N ячеек обнуляются (см. detail::InplaceArray)
+template <typename T, size_t N>
+class InplaceVector : private detail::InplaceStorage<T, N> {
+    using Storage = detail::InplaceStorage<T, N>;
+    using Storage::size_;
+
+    static constexpr bool TRIVIAL = detail::is_inplace_trivial_v<T>;
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    static constexpr size_t CAPACITY = N;
+
+    constexpr InplaceVector() = default;
+
+    constexpr explicit InplaceVector(size_t size) {
+        Resize(size);
+    }
+
+    constexpr InplaceVector(size_t size, const T& value) {
+        Resize(size, value);
+    }
+
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    constexpr InplaceVector(InputIt first, InputIt last) {
+        Assign(first, last);
+    }
+
+    constexpr InplaceVector(std::initializer_list<T> values) {
+        Assign(values.begin(), values.end());
+    }
+
+    constexpr iterator begin() noexcept {
+        return Data();
+    }
+    constexpr iterator end() noexcept {
+        return Data() + size_;
+    }
+    constexpr const_iterator begin() const noexcept {
+        return Data();
+    }
+    constexpr const_iterator end() const noexcept {
+        return Data() + size_;
+    }
+    constexpr const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    constexpr const_iterator cend() const noexcept {
+        return end();
+    }
+
+    constexpr T* Data() noexcept {
+        return Storage::Data();
+    }
+    constexpr const T* Data() const noexcept {
+        return Storage::Data();
+    }
+
+    constexpr const T& operator[](size_t index) const noexcept {
+        VECTOR_CHECK(index < size_, "index %zu out of range for size %zu", index, size_);
+        return Data()[index];
+    }
+
+    constexpr T& operator[](size_t index) noexcept {
+        VECTOR_CHECK(index < size_, "index %zu out of range for size %zu", index, size_);
+        return Data()[index];
+    }
+
+    constexpr size_t Size() const noexcept {
+        return size_;
+    }
+
+    static constexpr size_t Capacity() noexcept {
+        return N;
+    }
+
+    static constexpr size_t MaxSize() noexcept {
+        return N;
+    }
+
+    // Вместимость постоянна: проверяет лишь, что new_capacity элементов помещаются
+    constexpr void Reserve(size_t new_capacity) {
+        CheckCapacity(new_capacity);
+    }
+
+    constexpr void ShrinkToFit() noexcept {
+    }
+
+    constexpr void Swap(InplaceVector& other) {
+        InplaceVector tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    constexpr void Clear() noexcept {
+        Truncate(0);
+    }
+
+    constexpr void Resize(size_t new_size) {
+        CheckCapacity(new_size);
+        if (new_size <= size_) {
+            Truncate(new_size);
+        } else if constexpr (TRIVIAL) {
+            for (size_t i = size_; i < new_size; ++i) {
+                Data()[i] = T();
+            }
+            size_ = new_size;
+        } else {
+            std::uninitialized_value_construct_n(Data() + size_, new_size - size_);
+            size_ = new_size;
+        }
+    }
+
+    constexpr void Resize(size_t new_size, const T& value) {
+        if (new_size <= size_) {
+            Truncate(new_size);
+        } else {
+            Insert(end(), new_size - size_, value);
+        }
+    }
+
+    constexpr void PopBack() noexcept {
+        VECTOR_CHECK(size_ > 0, "PopBack on empty vector");
+        Truncate(size_ - 1);
+    }
+
+    // Добавляет элемент, если есть место, и возвращает указатель на него; в заполненном векторе — nullptr
+    template <typename... Args>
+    constexpr T* TryEmplaceBack(Args&&... args) {
+        if (VECTOR_UNLIKELY(size_ == N)) {
+            return nullptr;
+        }
+        T* const value = Construct(Data() + size_, std::forward<Args>(args)...);
+        ++size_;
+        return value;
+    }
+
+    constexpr T* TryPushBack(const T& value) {
+        return TryEmplaceBack(value);
+    }
+
+    constexpr T* TryPushBack(T&& value) {
+        return TryEmplaceBack(std::move(value));
+    }
+
+    template <typename... Args>
+    constexpr T& EmplaceBack(Args&&... args) {
+        CheckCapacity(size_ + 1);
+        return *TryEmplaceBack(std::forward<Args>(args)...);
+    }
+
+    constexpr void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    constexpr void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    template <typename... Args>
+    constexpr iterator Emplace(const_iterator pos, Args&&... args) {
+        VECTOR_CHECK(pos >= begin() && pos <= end(), "position %td outside [0, %zu]", pos - cbegin(), size_);
+        CheckCapacity(size_ + 1);
+        const size_t pos_num = pos - cbegin();
+        if constexpr (TRIVIAL) {
+            // args могут ссылаться на сдвигаемые элементы
+            T value = T(std::forward<Args>(args)...);
+            ShiftRight(pos_num, 1);
+            Data()[pos_num] = value;
+            return Data() + pos_num;
+        } else {
+            return detail::EmplaceInPlace(Data(), size_, pos_num, std::forward<Args>(args)...);
+        }
+    }
+
+    constexpr iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    constexpr iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    // Вставляет элементы диапазона [first, last) перед pos, сдвигая хвост один раз.
+    // Диапазон не должен указывать на элементы этого же вектора
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    constexpr iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+        VECTOR_CHECK(pos >= begin() && pos <= end(), "position %td outside [0, %zu]", pos - cbegin(), size_);
+        const size_t pos_num = pos - cbegin();
+        if constexpr (detail::is_forward_iterator_v<InputIt>) {
+            return InsertN(pos_num, first, static_cast<size_t>(std::distance(first, last)));
+        } else {
+            const size_t old_size = size_;
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+            std::rotate(begin() + pos_num, begin() + old_size, end());
+            return begin() + pos_num;
+        }
+    }
+
+    constexpr iterator Insert(const_iterator pos, size_t count, const T& value) {
+        VECTOR_CHECK(pos >= begin() && pos <= end(), "position %td outside [0, %zu]", pos - cbegin(), size_);
+        // value может ссылаться на сдвигаемый элемент
+        const T value_copy(value);
+        return InsertN(pos - cbegin(), detail::RepeatIterator<T>(value_copy, 0), count);
+    }
+
+    constexpr iterator Insert(const_iterator pos, std::initializer_list<T> values) {
+        return Insert(pos, values.begin(), values.end());
+    }
+
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    constexpr void Append(InputIt first, InputIt last) {
+        Insert(end(), first, last);
+    }
+
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    constexpr void Assign(InputIt first, InputIt last) {
+        if constexpr (detail::is_forward_iterator_v<InputIt>) {
+            const size_t count = static_cast<size_t>(std::distance(first, last));
+            CheckCapacity(count);
+            if constexpr (TRIVIAL) {
+                for (size_t i = 0; i < count; ++i, ++first) {
+                    Data()[i] = *first;
+                }
+                size_ = count;
+            } else {
+                detail::AssignInPlace(Data(), size_, first, count);
+            }
+        } else {
+            Clear();
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+        }
+    }
+
+    constexpr iterator Erase(const_iterator pos) {
+        VECTOR_CHECK(pos >= begin() && pos < end(), "position %td outside [0, %zu)", pos - cbegin(), size_);
+        return Erase(pos, pos + 1);
+    }
+
+    constexpr iterator Erase(const_iterator first, const_iterator last) {
+        VECTOR_CHECK(first >= begin() && first <= last && last <= end(), "range [%td, %td) outside [0, %zu]",
+                     first - cbegin(), last - cbegin(), size_);
+        const size_t pos_num = first - cbegin();
+        const size_t count = last - first;
+        if (count == 0) {
+            return begin() + pos_num;
+        }
+        if constexpr (TRIVIAL) {
+            for (size_t i = pos_num; i + count < size_; ++i) {
+                Data()[i] = Data()[i + count];
+            }
+            size_ -= count;
+        } else {
+            detail::EraseInPlace(Data(), size_, pos_num, count);
+        }
+        return begin() + pos_num;
+    }
+
+    // Удаляет элемент pos за O(1), перемещая на его место последний элемент
+    constexpr iterator UnorderedErase(const_iterator pos) {
+        VECTOR_CHECK(pos >= begin() && pos < end(), "position %td outside [0, %zu)", pos - cbegin(), size_);
+        const size_t pos_num = pos - cbegin();
+        if constexpr (TRIVIAL) {
+            Data()[pos_num] = Data()[size_ - 1];
+            --size_;
+        } else {
+            detail::UnorderedEraseInPlace(Data(), size_, pos_num);
+        }
+        return begin() + pos_num;
+    }
+
+private:
+    static constexpr void CheckCapacity(size_t required) {
+        if (VECTOR_UNLIKELY(required > N)) {
+            throw std::length_error("InplaceVector capacity exceeded");
+        }
+    }
+
+    template <typename... Args>
+    static constexpr T* Construct(T* where, Args&&... args) {
+        if constexpr (TRIVIAL) {
+            *where = T(std::forward<Args>(args)...);
+            return where;
+        } else {
+            return new (where) T(std::forward<Args>(args)...);
+        }
+    }
+
+    constexpr void Truncate(size_t new_size) noexcept {
+        if constexpr (!TRIVIAL) {
+            std::destroy_n(Data() + new_size, size_ - new_size);
+        }
+        size_ = new_size;
+    }
+
+    // Сдвигает тривиальные элементы начиная с pos на count ячеек к концу
+    constexpr void ShiftRight(size_t pos, size_t count) noexcept {
+        for (size_t i = size_; i > pos; --i) {
+            Data()[i - 1 + count] = Data()[i - 1];
+        }
+        size_ += count;
+    }
+
+    template <typename ForwardIt>
+    constexpr iterator InsertN(size_t pos_num, ForwardIt first, size_t count) {
+        CheckCapacity(size_ + count);
+        if (count == 0) {
+            return begin() + pos_num;
+        }
+        if constexpr (TRIVIAL) {
+            ShiftRight(pos_num, count);
+            for (size_t i = 0; i < count; ++i, ++first) {
+                Data()[pos_num + i] = *first;
+            }
+            return begin() + pos_num;
+        } else {
+            return detail::InsertInPlace(Data(), size_, pos_num, first, count);
+        }
+    }
+};
+
+template <typename T, size_t N, typename Predicate>
+size_t EraseIf(InplaceVector<T, N>& v, Predicate pred) {
+    const auto new_end = std::remove_if(v.begin(), v.end(), pred);
+    const size_t removed = v.end() - new_end;
+    v.Erase(new_end, v.end());
+    return removed;
+}
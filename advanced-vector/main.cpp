@@ -1,11 +1,45 @@
+// Тесты проверяют и сбор статистики (см. vector_stats.h)
+#define VECTOR_ENABLE_STATS
+
 #include "vector.h"
+#include "aligned_allocator.h"
+#include "arena_allocator.h"
+#include "pool_allocator.h"
+#include "concurrent_vector.h"
+#include "cow_vector.h"
+#include "flat_map.h"
+#include "flat_set.h"
+#include "huge_page_allocator.h"
+#include "inplace_vector.h"
+#include "mapped_vector.h"
+#include "recycling_allocator.h"
+#include "small_vector.h"
+#include "soa_vector.h"
+#include "stable_vector.h"
+#include "vector_simd.h"
+#include "vector_stats.h"
+#include "vector_stream.h"
+#include "vector_wire.h"
 
 #include <algorithm>
+#include <atomic>
+#include <filesystem>
 #include <iostream>
+#include <list>
+#include <map>
+#include <numeric>
+#include <random>
+#include <set>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+
 namespace {
 
 // "Магическое" число, используемое для отслеживания живости объекта
@@ -117,8 +151,233 @@ struct Obj {
     static inline int num_move_assigned = 0;
 };
 
+// Тип, который можно переносить побайтово: конструкторы перемещения и деструктор
+// не должны вызываться при реаллокации
+struct Relocatable {
+    Relocatable() = default;
+    explicit Relocatable(int id)
+        : id(id) {
+    }
+    Relocatable(const Relocatable& other)
+        : id(other.id) {
+        ++num_copied;
+    }
+    Relocatable(Relocatable&& other) noexcept
+        : id(other.id) {
+        ++num_moved;
+    }
+    Relocatable& operator=(const Relocatable& other) = default;
+    Relocatable& operator=(Relocatable&& other) = default;
+    ~Relocatable() {
+        ++num_destroyed;
+    }
+
+    static void ResetCounters() {
+        num_copied = 0;
+        num_moved = 0;
+        num_destroyed = 0;
+    }
+
+    int id = 0;
+
+    static inline int num_copied = 0;
+    static inline int num_moved = 0;
+    static inline int num_destroyed = 0;
+};
+
+// Элемент, допускающий одновременное создание из разных потоков
+struct Counted {
+    Counted() {
+        if (construction_throw_at.load() != 0 && ++num_constructions == construction_throw_at.load()) {
+            throw std::runtime_error("Oops");
+        }
+        ++num_alive;
+    }
+    Counted(const Counted& other)
+        : value(other.value) {
+        ++num_alive;
+    }
+    Counted& operator=(const Counted&) = default;
+    ~Counted() {
+        --num_alive;
+    }
+    int value = 7;
+
+    static inline std::atomic<int> num_alive = 0;
+    static inline std::atomic<int> num_constructions = 0;
+    static inline std::atomic<int> construction_throw_at = 0;
+};
+
+// Аллокатор поверх malloc/realloc, считающий вызовы allocate и reallocate
+template <typename T>
+struct ReallocatingAllocator {
+    using value_type = T;
+
+    ReallocatingAllocator() = default;
+
+    template <typename U>
+    ReallocatingAllocator(const ReallocatingAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        ++num_allocate;
+        return static_cast<T*>(std::malloc(n * sizeof(T)));
+    }
+
+    T* reallocate(T* ptr, size_t, size_t new_n) {
+        if (reallocate_throws) {
+            throw std::bad_alloc();
+        }
+        ++num_reallocate;
+        return static_cast<T*>(std::realloc(ptr, new_n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t) noexcept {
+        std::free(ptr);
+    }
+
+    bool operator==(const ReallocatingAllocator&) const noexcept {
+        return true;
+    }
+
+    bool operator!=(const ReallocatingAllocator&) const noexcept {
+        return false;
+    }
+
+    static void ResetCounters() {
+        num_allocate = 0;
+        num_reallocate = 0;
+        reallocate_throws = false;
+    }
+
+    static inline int num_allocate = 0;
+    static inline int num_reallocate = 0;
+    static inline bool reallocate_throws = false;
+};
+
+// Аллокатор с меткой, распространяющийся при копировании, перемещении и обмене контейнеров
+template <typename T>
+struct TaggedAllocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    explicit TaggedAllocator(int tag) noexcept
+        : tag(tag) {
+    }
+
+    template <typename U>
+    TaggedAllocator(const TaggedAllocator<U>& other) noexcept
+        : tag(other.tag) {
+    }
+
+    T* allocate(size_t n) {
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        std::allocator<T>().deallocate(ptr, n);
+    }
+
+    bool operator==(const TaggedAllocator& other) const noexcept {
+        return tag == other.tag;
+    }
+
+    bool operator!=(const TaggedAllocator& other) const noexcept {
+        return tag != other.tag;
+    }
+
+    int tag;
+};
+
+// Выполняет body в дочернем процессе и возвращает то, что он вывел в stderr,
+// если процесс завершился через abort, иначе пустую строку
+template <typename F>
+std::string CheckFailureMessage(F body) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        throw std::runtime_error("pipe failed");
+    }
+    std::fflush(nullptr);
+    const pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        dup2(fds[1], STDERR_FILENO);
+        body();
+        std::_Exit(0);
+    }
+    close(fds[1]);
+    std::string message;
+    char buffer[256];
+    for (ssize_t n; (n = read(fds[0], buffer, sizeof(buffer))) > 0;) {
+        message.append(buffer, static_cast<size_t>(n));
+    }
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT ? message : std::string();
+}
+
+// Сверяет операции vector_simd с последовательными алгоритмами для разных размеров и смещений
+template <typename T>
+void CheckSimdOperations() {
+    using vector_simd::SumType;
+    for (size_t size : {0, 1, 3, 15, 16, 17, 63, 64, 65, 200, 1000, 4099}) {
+        Vector<T> v;
+        for (size_t i = 0; i < size; ++i) {
+            v.PushBack(static_cast<T>((i * 7) % 50));
+        }
+        Vector<T> copy(v);
+        assert(copy == v && !(copy != v));
+        if (size > 0) {
+            copy[size - 1] = static_cast<T>(copy[size - 1] + 1);
+            assert(copy != v);
+            copy[size / 2] = static_cast<T>(200);
+            assert(vector_simd::Find(copy, static_cast<T>(200)) == copy.begin() + size / 2);
+            const auto [min, max] = vector_simd::MinMax(v);
+            const auto [min_it, max_it] = std::minmax_element(v.begin(), v.end());
+            assert(min == *min_it && max == *max_it);
+        }
+        assert(vector_simd::Find(v, static_cast<T>(102)) == v.end());
+        assert(vector_simd::Find(std::as_const(v), static_cast<T>(5)) == std::find(v.cbegin(), v.cend(), static_cast<T>(5)));
+        assert(vector_simd::Count(v, static_cast<T>(3)) == static_cast<size_t>(std::count(v.begin(), v.end(), static_cast<T>(3))));
+        const SumType<T> sum = std::accumulate(v.begin(), v.end(), SumType<T>{});
+        assert(vector_simd::Sum(v) == sum);
+
+        vector_simd::Transform(v, copy, [](auto x) {
+            return x * static_cast<T>(2) + static_cast<T>(1);
+        });
+        assert(copy.Size() == size);
+        for (size_t i = 0; i < size; ++i) {
+            assert(copy[i] == static_cast<T>(v[i] * 2 + 1));
+        }
+        // op только для скалярного T
+        vector_simd::Transform(copy, copy, [](T x) -> T {
+            return static_cast<T>(x - 1);
+        });
+        assert(size == 0 || copy[size - 1] == static_cast<T>(v[size - 1] * 2));
+
+        vector_simd::Fill(copy, static_cast<T>(9));
+        assert(vector_simd::Count(copy, static_cast<T>(9)) == size);
+        vector_simd::CopyFrom(copy, v);
+        assert(copy == v);
+        vector_simd::CopyFrom(copy, v.Data() + size / 2, size - size / 2);
+        assert(copy.Size() == size - size / 2 && vector_simd::Equal(copy.Data(), v.Data() + size / 2, copy.Size()));
+    }
+    // счётчики совпадений не переполняются на длинных отрезках
+    Vector<T> same;
+    same.Resize(100000);
+    vector_simd::Fill(same, static_cast<T>(1));
+    assert(vector_simd::Count(same, static_cast<T>(1)) == 100000);
+    assert(vector_simd::Find(same, static_cast<T>(0)) == same.end());
+}
+
 }  // namespace
 
+template <>
+struct is_trivially_relocatable<Relocatable> : std::true_type {};
+
 void Test1() {
     Obj::ResetCounters();
     const size_t SIZE = 100500;
@@ -433,7 +692,7 @@ void Test6() {
     {
         Obj::ResetCounters();
         Vector<Obj> v;
-        auto* pos = v.Emplace(v.end(), Obj{1});
+        auto pos = v.Emplace(v.end(), Obj{1});
         assert(v.Size() == 1);
         assert(v.Capacity() >= v.Size());
         assert(&*pos == &v[0]);
@@ -448,7 +707,7 @@ void Test6() {
         Obj::ResetCounters();
         Vector<Obj> v;
         v.Reserve(SIZE);
-        auto* pos = v.Emplace(v.end(), Obj{1});
+        auto pos = v.Emplace(v.end(), Obj{1});
         assert(v.Size() == 1);
         assert(v.Capacity() >= v.Size());
         assert(&*pos == &v[0]);
@@ -495,7 +754,7 @@ void Test6() {
     {
         Obj::ResetCounters();
         Vector<Obj> v{SIZE};
-        auto* pos = v.Emplace(v.cbegin() + 1, ID, "Ivan"s);
+        auto pos = v.Emplace(v.cbegin() + 1, ID, "Ivan"s);
         assert(v.Size() == SIZE + 1);
         assert(v.Capacity() == SIZE * 2);
         assert(&*pos == &v[1]);
@@ -511,7 +770,7 @@ void Test6() {
     {
         Obj::ResetCounters();
         Vector<Obj> v{SIZE};
-        auto* pos = v.Emplace(v.cbegin() + v.Size(), ID, "Ivan"s);
+        auto pos = v.Emplace(v.cbegin() + v.Size(), ID, "Ivan"s);
         assert(v.Size() == SIZE + 1);
         assert(v.Capacity() == SIZE * 2);
         assert(&*pos == &v[SIZE]);
@@ -530,7 +789,7 @@ void Test6() {
         v.Reserve(SIZE * 2);
         const int old_num_moved = Obj::num_moved;
         assert(v.Capacity() == SIZE * 2);
-        auto* pos = v.Emplace(v.cbegin() + 3, ID, "Ivan"s);
+        auto pos = v.Emplace(v.cbegin() + 3, ID, "Ivan"s);
         assert(v.Size() == SIZE + 1);
         assert(&*pos == &v[3]);
         assert(v[3].id == ID);
@@ -546,7 +805,7 @@ void Test6() {
         Obj::ResetCounters();
         Vector<Obj> v{SIZE};
         v[2].id = ID;
-        auto* pos = v.Erase(v.cbegin() + 1);
+        auto pos = v.Erase(v.cbegin() + 1);
         assert((pos - v.begin()) == 1);
         assert(v.Size() == SIZE - 1);
         assert(v.Capacity() == SIZE);
@@ -559,84 +818,2050 @@ void Test6() {
     }
 }
 
-struct C {
-    C() noexcept {
-        ++def_ctor;
+void Test7() {
+    const size_t SIZE = 1000;
+    {
+        Vector<int> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        v.Insert(v.cbegin() + 1, -1);
+        v.Reserve(v.Capacity() * 2);
+        assert(v.Size() == SIZE + 1);
+        assert(v[0] == 0 && v[1] == -1 && v[2] == 1);
+        assert(v[SIZE] == static_cast<int>(SIZE - 1));
     }
-    C(const C& /*other*/) noexcept {
-        ++copy_ctor;
+    {
+        Relocatable::ResetCounters();
+        {
+            Vector<Relocatable> v(SIZE);
+            v[SIZE - 1].id = 42;
+            v.Reserve(SIZE * 2);
+            assert(v[SIZE - 1].id == 42);
+            Vector<Relocatable> v_full(SIZE);
+            v_full.Emplace(v_full.cbegin() + 1, 2);
+            Vector<Relocatable> v_back(SIZE);
+            v_back.EmplaceBack(1);
+            assert(v_full[1].id == 2 && v_back[SIZE].id == 1);
+            assert(Relocatable::num_copied == 0);
+            assert(Relocatable::num_moved == 0);
+            assert(Relocatable::num_destroyed == 0);
+        }
+        assert(Relocatable::num_destroyed == static_cast<int>(3 * SIZE + 2));
     }
-    C(C&& /*other*/) noexcept {
-        ++move_ctor;
+    {
+        Vector<std::unique_ptr<int>> v;
+        v.Reserve(SIZE);
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.PushBack(std::make_unique<int>(i));
+        }
+        v.Insert(v.cbegin() + 2, std::make_unique<int>(-1));
+        assert(*v[0] == 0 && *v[2] == -1 && *v[SIZE] == static_cast<int>(SIZE - 1));
     }
-    C& operator=(const C& other) noexcept {
-        if (this != &other) {
-            ++copy_assign;
+}
+
+void Test8() {
+    const size_t SIZE = 1000;
+    {
+        Arena arena(1024);
+        Obj::ResetCounters();
+        {
+            using ArenaVector = Vector<Obj, ArenaAllocator<Obj>>;
+            ArenaVector v{ArenaAllocator<Obj>(arena)};
+            for (size_t i = 0; i < SIZE; ++i) {
+                v.EmplaceBack(static_cast<int>(i));
+            }
+            assert(arena.BytesReserved() >= SIZE * sizeof(Obj));
+            assert(v[SIZE - 1].id == static_cast<int>(SIZE - 1));
+
+            ArenaVector v_copy(v);
+            assert(&v_copy.GetAllocator().GetArena() == &arena);
+            assert(v_copy.Size() == SIZE && v_copy[SIZE / 2].id == static_cast<int>(SIZE / 2));
+
+            Arena other_arena;
+            ArenaVector v_other(3, ArenaAllocator<Obj>(other_arena));
+            // Аллокаторы не распространяются: элементы перемещаются в память другой арены
+            v_other = std::move(v_copy);
+            assert(&v_other.GetAllocator().GetArena() == &other_arena);
+            assert(v_other.Size() == SIZE && v_other[SIZE - 1].id == static_cast<int>(SIZE - 1));
+            v_other = v;
+            assert(v_other.Size() == SIZE && v_other[1].id == 1);
+
+            ArenaVector v_same(5, ArenaAllocator<Obj>(arena));
+            v_same.Swap(v);
+            assert(v_same.Size() == SIZE && v.Size() == 5);
         }
-        return *this;
+        assert(Obj::GetAliveObjectCount() == 0);
     }
-    C& operator=(C&& /*other*/) noexcept {
-        ++move_assign;
-        return *this;
+    {
+        FixedPool pool(16 * sizeof(int));
+        Vector<int, PoolAllocator<int>> v{PoolAllocator<int>(pool)};
+        v.Reserve(16);
+        assert(pool.BlocksInUse() == 1);
+        for (int i = 0; i < 16; ++i) {
+            v.PushBack(i);
+        }
+        {
+            Vector<int, PoolAllocator<int>> v_copy(v);
+            assert(pool.BlocksInUse() == 2);
+        }
+        assert(pool.BlocksInUse() == 1);
+        v.PushBack(16);
+        assert(pool.BlocksInUse() == 0);
+        assert(v.Size() == 17 && v[15] == 15 && v[16] == 16);
     }
-    ~C() {
-        ++dtor;
+    {
+        using TaggedVector = Vector<int, TaggedAllocator<int>>;
+        TaggedVector v1(SIZE, TaggedAllocator<int>(1));
+        TaggedVector v2(10, TaggedAllocator<int>(2));
+        v2 = v1;
+        assert(v2.GetAllocator().tag == 1 && v2.Size() == SIZE);
+        TaggedVector v3(1, TaggedAllocator<int>(3));
+        v3.Swap(v2);
+        assert(v3.GetAllocator().tag == 1 && v2.GetAllocator().tag == 3);
+        v2 = std::move(v3);
+        assert(v2.GetAllocator().tag == 1 && v2.Size() == SIZE);
     }
+}
 
-    static void Reset() {
-        def_ctor = 0;
-        copy_ctor = 0;
-        move_ctor = 0;
-        copy_assign = 0;
-        move_assign = 0;
-        dtor = 0;
+void Test9() {
+    const auto capacities = [](auto v, size_t count) {
+        std::vector<size_t> result;
+        for (size_t i = 0; i < count; ++i) {
+            v.PushBack(static_cast<int>(i));
+            if (result.empty() || result.back() != v.Capacity()) {
+                result.push_back(v.Capacity());
+            }
+        }
+        return result;
+    };
+    assert((capacities(Vector<int>(), 20) == std::vector<size_t>{1, 2, 4, 8, 16, 32}));
+    assert((capacities(Vector<int, std::allocator<int>, OneAndHalfGrowth>(), 20)
+            == std::vector<size_t>{1, 2, 3, 4, 6, 9, 13, 19, 28}));
+    assert((capacities(Vector<int, std::allocator<int>, CacheLineGrowth>(), 20) == std::vector<size_t>{16, 24}));
+    assert((capacities(Vector<int, std::allocator<int>, GeometricGrowth<2, 1, 0, 64>>(), 60)
+            == std::vector<size_t>{1, 2, 4, 8, 16, 32, 48, 64}));
+    {
+        Vector<int, std::allocator<int>, GoldenRatioGrowth> v(100);
+        v.PushBack(1);
+        assert(v.Capacity() == 162 && v.Size() == 101 && v[100] == 1);
+    }
+    {
+        const size_t max_size = std::numeric_limits<size_t>::max() / 4;
+        assert(OneAndHalfGrowth::NextCapacity(max_size - 1, max_size, 4, max_size) == max_size);
+        assert(DoublingGrowth::NextCapacity(max_size / 2 + 1, max_size / 2 + 2, 4, max_size) == max_size);
+        try {
+            DoublingGrowth::NextCapacity(max_size, max_size + 1, 4, max_size);
+            assert(false && "Exception is expected");
+        } catch (const std::length_error&) {
+        }
+        Vector<int> v;
+        try {
+            v.Reserve(v.MaxSize() + 1);
+            assert(false && "Exception is expected");
+        } catch (const std::length_error&) {
+        }
+        assert(v.Capacity() == 0);
     }
+}
 
-    inline static size_t def_ctor = 0;
-    inline static size_t copy_ctor = 0;
-    inline static size_t move_ctor = 0;
-    inline static size_t copy_assign = 0;
-    inline static size_t move_assign = 0;
-    inline static size_t dtor = 0;
-};
+void Test10() {
+    const size_t STEP = 3;
+    const size_t STEPS = 1000;
+    {
+        Vector<int> v;
+        size_t reallocations = 0;
+        for (size_t i = 0; i < STEPS; ++i) {
+            const size_t old_capacity = v.Capacity();
+            v.Resize(v.Size() + STEP);
+            v[v.Size() - 1] = static_cast<int>(i);
+            reallocations += v.Capacity() != old_capacity ? 1 : 0;
+        }
+        assert(v.Size() == STEP * STEPS);
+        assert(v[v.Size() - 1] == static_cast<int>(STEPS - 1) && v[0] == 0);
+        assert(reallocations <= 12);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(2);
+        v[0].id = 42;
+        v.Resize(10, v[0]);
+        assert(v.Size() == 10 && v.Capacity() == 10);
+        assert(std::all_of(v.begin() + 2, v.end(), [](const Obj& obj) {
+            return obj.id == 42;
+        }));
+        v.Resize(12, v[9]);
+        assert(v.Capacity() == 20 && v[11].id == 42);
+        assert(Obj::num_copied == 10);
+        v.Resize(1, v[0]);
+        assert(v.Size() == 1 && v.Capacity() == 20);
+        assert(Obj::GetAliveObjectCount() == 1);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        v.ResizeDefaultInit(5);
+        assert(v.Size() == 5 && Obj::num_default_constructed == 5);
+        Vector<int> v_int;
+        v_int.ResizeDefaultInit(100);
+        assert(v_int.Size() == 100 && v_int.Capacity() == 100);
+        v_int.ResizeDefaultInit(10);
+        assert(v_int.Size() == 10);
+    }
+}
+
+void Test11() {
+    using namespace std::literals;
+    const auto equals = [](const auto& v, std::initializer_list<int> expected) {
+        return v.Size() == expected.size() && std::equal(v.begin(), v.end(), expected.begin());
+    };
+    {
+        Vector<int> v;
+        v.Insert(v.cbegin(), {1, 5});
+        const std::vector<int> src{2, 3, 4};
+        auto pos = v.Insert(v.cbegin() + 1, src.begin(), src.end());
+        assert(pos == v.begin() + 1);
+        assert(equals(v, {1, 2, 3, 4, 5}));
+        const std::list<int> tail{6, 7};
+        v.Append(tail.begin(), tail.end());
+        assert(equals(v, {1, 2, 3, 4, 5, 6, 7}));
+        v.Insert(v.cend(), 2, v[0]);
+        assert(equals(v, {1, 2, 3, 4, 5, 6, 7, 1, 1}));
+        v.Reserve(20);
+        v.Insert(v.cbegin(), 3, v[6]);
+        assert(equals(v, {7, 7, 7, 1, 2, 3, 4, 5, 6, 7, 1, 1}));
+        std::istringstream input("8 9"s);
+        v.Insert(v.cbegin() + 1, std::istream_iterator<int>(input), std::istream_iterator<int>());
+        assert(equals(v, {7, 8, 9, 7, 7, 1, 2, 3, 4, 5, 6, 7, 1, 1}));
+        v.Assign(src.begin(), src.end());
+        assert(equals(v, {2, 3, 4}) && v.Capacity() == 20);
+        std::istringstream more("1 2 3 4"s);
+        v.Assign(std::istream_iterator<int>(more), std::istream_iterator<int>());
+        assert(equals(v, {1, 2, 3, 4}));
+    }
+    {
+        // Вставка в середину при достаточной вместимости сдвигает хвост один раз
+        const size_t SIZE = 10;
+        const size_t COUNT = 3;
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 2);
+        std::vector<Obj> batch(COUNT);
+        v.Insert(v.cbegin() + 2, batch.begin(), batch.end());
+        assert(v.Size() == SIZE + COUNT && v.Capacity() == SIZE * 2);
+        assert(Obj::num_moved == static_cast<int>(SIZE + COUNT));
+        assert(Obj::num_move_assigned == static_cast<int>(SIZE - 2 - COUNT));
+        assert(Obj::num_assigned == static_cast<int>(COUNT));
+
+        // При нехватке места буфер выделяется один раз, а каждый элемент перемещается один раз
+        const int moved_before = Obj::num_moved;
+        std::vector<Obj> big_batch(SIZE * 2);
+        v.Insert(v.cbegin() + 1, big_batch.begin(), big_batch.end());
+        assert(v.Size() == SIZE * 3 + COUNT);
+        assert(v.Capacity() == SIZE * 4);
+        assert(Obj::num_moved - moved_before == static_cast<int>(SIZE + COUNT));
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(5);
+        std::vector<Obj> batch(3);
+        batch[1].throw_on_copy = true;
+        try {
+            v.Insert(v.cbegin() + 1, batch.begin(), batch.end());
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 5 && v.Capacity() == 5);
+        assert(Obj::GetAliveObjectCount() == 8);
+        Vector<Obj> v_small(1);
+        try {
+            v_small.Assign(batch.begin(), batch.end());
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v_small.Size() == 1 && v_small.Capacity() == 1);
+        assert(Obj::GetAliveObjectCount() == 9);
+    }
+    {
+        Vector<int> v(3);
+        std::iota(v.begin(), v.end(), 0);
+        v.Reserve(10);
+        int extra[] = {-1, -2};
+        v.Insert(v.cbegin() + 1, std::begin(extra), std::end(extra));
+        assert(equals(v, {0, -1, -2, 1, 2}));
+    }
+}
 
-void Dump() {
-    using namespace std;
-    cerr << "Def ctors: "sv << C::def_ctor              //
-         << ", Copy ctors: "sv << C::copy_ctor          //
-         << ", Move ctors: "sv << C::move_ctor          //
-         << ", Copy assignments: "sv << C::copy_assign  //
-         << ", Move assignments: "sv << C::move_assign  //
-         << ", Dtors: "sv << C::dtor << endl;
+void Test12() {
+    const size_t SIZE = 10;
+    {
+        Vector<int> v(SIZE);
+        std::iota(v.begin(), v.end(), 0);
+        auto pos = v.Erase(v.cbegin() + 2, v.cbegin() + 5);
+        assert(*pos == 5 && v.Size() == SIZE - 3);
+        assert(v[1] == 1 && v[2] == 5 && v[SIZE - 4] == 9);
+        pos = v.Erase(v.cbegin() + 1, v.cbegin() + 1);
+        assert(*pos == 1 && v.Size() == SIZE - 3);
+        pos = v.UnorderedErase(v.cbegin());
+        assert(*pos == 9 && v.Size() == SIZE - 4 && v[1] == 1);
+        pos = v.UnorderedErase(v.cend() - 1);
+        assert(pos == v.end() && v.Size() == SIZE - 5);
+        assert(EraseIf(v, [](int x) { return x % 2 == 1; }) == 4);
+        assert(v.Size() == 1 && v[0] == 6 && v.Capacity() == SIZE);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].id = static_cast<int>(i);
+        }
+        v.Erase(v.cbegin() + 1, v.cbegin() + 4);
+        assert(v.Size() == SIZE - 3 && v[1].id == 4);
+        assert(Obj::num_move_assigned == static_cast<int>(SIZE - 4));
+        assert(Obj::num_destroyed == 3);
+        v.UnorderedErase(v.cbegin() + 1);
+        assert(v[1].id == static_cast<int>(SIZE - 1));
+        assert(Obj::num_move_assigned == static_cast<int>(SIZE - 3));
+        assert(Obj::num_destroyed == 4);
+        assert(EraseIf(v, [](const Obj& obj) { return obj.id > 5; }) == 4);
+        assert(v.Size() == 2 && v[0].id == 0 && v[1].id == 5);
+        assert(Obj::GetAliveObjectCount() == 2);
+    }
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.PushBack(std::make_unique<int>(i));
+        }
+        v.Erase(v.cbegin(), v.cbegin() + 2);
+        v.UnorderedErase(v.cbegin());
+        assert(v.Size() == SIZE - 3 && *v[0] == 9 && *v[1] == 3);
+    }
 }
 
-void Benchmark() {
-    using namespace std;
-    try {
-        const size_t NUM = 10;
-        C c;
-        {
-            cerr << "std::vector:"sv << endl;
-            C::Reset();
-            vector<C> v(NUM);
-            Dump();
-            v.push_back(c);
+void Test13() {
+    using namespace std::literals;
+    const size_t N = 4;
+    {
+        SmallVector<int, N> v;
+        assert(v.IsInline() && v.Capacity() == N && v.Size() == 0);
+        for (int i = 0; i < static_cast<int>(N); ++i) {
+            v.PushBack(i);
         }
-        Dump();
-    } catch (...) {
+        assert(v.IsInline() && v.Size() == N);
+        v.PushBack(static_cast<int>(N));
+        assert(!v.IsInline() && v.Capacity() == N * 2);
+        v.Insert(v.cbegin() + 1, {10, 11});
+        v.Erase(v.cbegin() + 3, v.cbegin() + 5);
+        assert(v.Size() == N + 1 && v[0] == 0 && v[1] == 10 && v[2] == 11 && v[3] == 3);
+        assert(EraseIf(v, [](int x) { return x >= 10; }) == 2);
+        assert(v.Size() == 3 && v[1] == 3);
     }
-    try {
-        const size_t NUM = 10;
-        C c;
+    {
+        Obj::ResetCounters();
         {
-            cerr << "Vector:"sv << endl;
-            C::Reset();
-            Vector<C> v(NUM);
-            Dump();
-            v.PushBack(c);
+            SmallVector<Obj, N> inline_v;
+            inline_v.EmplaceBack(1, "one"s);
+            inline_v.EmplaceBack(2, "two"s);
+            SmallVector<Obj, N> heap_v(N * 2);
+            heap_v[0].id = 42;
+
+            SmallVector<Obj, N> copy(inline_v);
+            assert(copy.IsInline() && copy.Size() == 2 && copy[1].id == 2);
+            SmallVector<Obj, N> moved(std::move(copy));
+            assert(moved.IsInline() && moved.Size() == 2 && copy.Size() == 0);
+
+            const int* heap_data = &heap_v[0].id;
+            SmallVector<Obj, N> moved_heap(std::move(heap_v));
+            assert(&moved_heap[0].id == heap_data && heap_v.IsInline() && heap_v.Size() == 0);
+
+            moved.Swap(moved_heap);
+            assert(moved.Size() == N * 2 && moved[0].id == 42);
+            assert(moved_heap.Size() == 2 && moved_heap.IsInline() && moved_heap[0].id == 1);
+
+            moved_heap = moved;
+            assert(moved_heap.Size() == N * 2 && !moved_heap.IsInline());
+            inline_v = std::move(moved_heap);
+            assert(inline_v.Size() == N * 2 && inline_v[0].id == 42);
+            inline_v.Resize(1);
+            inline_v.Resize(3, inline_v[0]);
+            assert(inline_v.Size() == 3 && inline_v[2].id == 42);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        // Переход в динамическую память сохраняет строгую гарантию безопасности исключений
+        struct MayThrowOnMove {
+            MayThrowOnMove() = default;
+            MayThrowOnMove(const MayThrowOnMove&) = default;
+            MayThrowOnMove(MayThrowOnMove&& other) noexcept(false)
+                : obj(std::move(other.obj)) {
+            }
+            MayThrowOnMove& operator=(const MayThrowOnMove&) = default;
+            MayThrowOnMove& operator=(MayThrowOnMove&&) = default;
+            Obj obj;
+        };
+        Obj::ResetCounters();
+        SmallVector<MayThrowOnMove, N> v(N);
+        v[1].obj.throw_on_copy = true;
+        try {
+            v.EmplaceBack();
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == N && v.IsInline());
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(N));
+        v[1].obj.throw_on_copy = false;
+        v.EmplaceBack();
+        assert(v.Size() == N + 1 && !v.IsInline() && Obj::num_moved == 0);
+        SmallVector<Obj, N> v_small(2);
+        v_small[0].throw_on_copy = true;
+        try {
+            SmallVector<Obj, N> copy(v_small);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(N + 3));
+    }
+    {
+        // автоматическое уменьшение: сначала динамический буфер, затем переход во встроенный
+        SmallVector<int, N, std::allocator<int>, HysteresisShrink<>> v(64);
+        std::iota(v.begin(), v.end(), 0);
+        v.Resize(15);
+        assert(v.Capacity() == 30 && !v.IsInline() && v[14] == 14);
+        v.Erase(v.cbegin() + 2, v.cend());
+        assert(v.Size() == 2 && v.IsInline() && v[1] == 1);
+        v.PopBack();
+        assert(v.Size() == 1 && v.Capacity() == N && v[0] == 0);
+    }
+    {
+        // аллокатор переходит при копирующем и перемещающем присваивании
+        using TaggedSmall = SmallVector<int, N, TaggedAllocator<int>>;
+        TaggedSmall heap_v(N * 2, TaggedAllocator<int>(1));
+        TaggedSmall inline_v(1, TaggedAllocator<int>(2));
+        TaggedSmall dst(N * 4, TaggedAllocator<int>(3));
+        dst = heap_v;
+        assert(dst.GetAllocator().tag == 1 && dst.Size() == N * 2);
+        dst = std::move(inline_v);
+        assert(dst.GetAllocator().tag == 2 && dst.Size() == 1 && dst.IsInline() && inline_v.Size() == 0);
+        const int* const heap_data = heap_v.begin();
+        dst = std::move(heap_v);
+        assert(dst.GetAllocator().tag == 1 && dst.begin() == heap_data && heap_v.Size() == 0);
+    }
+}
+
+void Test14() {
+    struct alignas(64) PerThreadCounter {
+        uint64_t value = 0;
+    };
+    const auto is_aligned = [](const void* ptr, size_t alignment) {
+        return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+    };
+    {
+        Vector<PerThreadCounter> v;
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(PerThreadCounter{static_cast<uint64_t>(i)});
+            assert(is_aligned(&v[0], alignof(PerThreadCounter)));
+        }
+        assert(v[99].value == 99);
+        SmallVector<PerThreadCounter, 2> small_v(1);
+        assert(is_aligned(&small_v[0], alignof(PerThreadCounter)));
+    }
+    {
+        AlignedVector<float, 64> v(3);
+        assert(is_aligned(v.Data(), 64));
+        v.Resize(1000);
+        assert(is_aligned(v.Data(), 64));
+        AlignedVector<char, 4096> page(1);
+        assert(is_aligned(page.Data(), 4096));
+        page.Reserve(4096 * 3);
+        assert(is_aligned(page.Data(), 4096));
+        const AlignedVector<char, 4096> page_copy(page);
+        assert(is_aligned(page_copy.Data(), 4096));
+        AlignedVector<float, 8> small_alignment(5);
+        assert(is_aligned(small_alignment.Data(), 8));
+    }
+}
+
+void Test15() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Resize(SIZE / 2);
+        assert(v.Capacity() == SIZE);
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE / 2 && v.Size() == SIZE / 2);
+        assert(Obj::num_moved == static_cast<int>(SIZE / 2) && Obj::num_copied == 0);
+        v.Clear();
+        assert(v.Size() == 0 && v.Capacity() == SIZE / 2);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0);
+        v.Resize(10);
+        v.ClearAndRelease();
+        assert(v.Size() == 0 && v.Capacity() == 0);
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        Vector<int, std::allocator<int>, HysteresisShrink<>> v(SIZE);
+        std::iota(v.begin(), v.end(), 0);
+        v.Resize(SIZE / 4);
+        assert(v.Capacity() == SIZE);
+        v.PopBack();
+        assert(v.Size() == SIZE / 4 - 1 && v.Capacity() == (SIZE / 4 - 1) * 2);
+        assert(v[SIZE / 4 - 2] == static_cast<int>(SIZE / 4 - 2));
+        // Колебания размера около порога не вызывают перевыделений
+        const size_t capacity = v.Capacity();
+        for (int i = 0; i < 10; ++i) {
+            v.PushBack(i);
+            v.PopBack();
+        }
+        assert(v.Capacity() == capacity);
+        v.Erase(v.cbegin(), v.cend() - 2);
+        assert(v.Size() == 2 && v.Capacity() == 4);
+        v.UnorderedErase(v.cbegin());
+        v.UnorderedErase(v.cbegin());
+        assert(v.Size() == 0 && v.Capacity() == 0);
+    }
+    {
+        SmallVector<int, 4> v(10);
+        v.Resize(3);
+        v.ShrinkToFit();
+        assert(v.IsInline() && v.Size() == 3 && v.Capacity() == 4);
+        v.Resize(10);
+        v.Resize(6);
+        v.ShrinkToFit();
+        assert(!v.IsInline() && v.Capacity() == 6);
+        v.ClearAndRelease();
+        assert(v.IsInline() && v.Size() == 0);
+    }
+}
+
+void Test16() {
+    struct Movable {
+        Movable() = default;
+        Movable(const Movable&) = default;
+        Movable(Movable&&) noexcept {
+        }
+        Movable& operator=(const Movable&) = default;
+        Movable& operator=(Movable&&) = default;
+        std::string payload;
+    };
+    struct CopiedOnGrowth {
+        CopiedOnGrowth() = default;
+        CopiedOnGrowth(const CopiedOnGrowth&) = default;
+        CopiedOnGrowth(CopiedOnGrowth&&) {
+        }
+        CopiedOnGrowth& operator=(const CopiedOnGrowth&) = default;
+        CopiedOnGrowth& operator=(CopiedOnGrowth&&) = default;
+        std::string payload;
+    };
+    struct Trivial {
+        int value;
+    };
+    const auto stats_of = [](const std::string& name) {
+        for (const auto& [type, counters] : vector_stats::Collect()) {
+            if (type.find(name) != std::string::npos) {
+                return counters;
+            }
+        }
+        return vector_stats::Counters{};
+    };
+    {
+        Vector<Movable> v;
+        for (int i = 0; i < 5; ++i) {
+            v.EmplaceBack();
+        }
+        // вместимость 1, 2, 4, 8: при росте перенесено 1 + 2 + 4 элементов
+        const auto counters = stats_of("Movable");
+        assert(counters.allocations == 4 && counters.deallocations == 3);
+        assert(counters.reallocations == 3);
+        assert(counters.elements_moved == 7 && counters.elements_copied == 0);
+        assert(counters.peak_capacity == 8 && counters.live_capacity == 8);
+        assert(counters.peak_live_capacity == 12);
+    }
+    {
+        const auto counters = stats_of("Movable");
+        assert(counters.live_capacity == 0 && counters.releases == 1 && counters.wasted_capacity == 3);
+    }
+    {
+        Vector<CopiedOnGrowth> v(3);
+        v.Reserve(10);
+        const auto counters = stats_of("CopiedOnGrowth");
+        assert(counters.reallocations == 1 && counters.elements_copied == 3 && counters.elements_moved == 0);
+    }
+    {
+        SmallVector<Trivial, 2> v(2);
+        v.EmplaceBack();
+        const auto counters = stats_of("Trivial");
+        assert(counters.allocations == 1 && counters.elements_relocated == 2);
+    }
+    {
+        // рост через reallocate аллокатора учитывается так же, как перенос в новый буфер
+        struct GrownInPlace {
+            int value;
+        };
+        Vector<GrownInPlace, ReallocatingAllocator<GrownInPlace>> v;
+        for (int i = 0; i < 5; ++i) {
+            v.PushBack({i});
         }
-        Dump();
-    } catch (...) {
+        v.Reserve(20);
+        const auto counters = stats_of("GrownInPlace");
+        assert(counters.reallocations == 4 && counters.elements_relocated == 7 + 5);
+        assert(counters.allocations == 5 && counters.deallocations == 4 && counters.live_capacity == 20);
+    }
+    {
+        std::ostringstream out;
+        vector_stats::Dump(out);
+        assert(out.str().find("CopiedOnGrowth") != std::string::npos);
+        vector_stats::Reset();
+        const auto counters = stats_of("CopiedOnGrowth");
+        assert(counters.allocations == 0 && counters.elements_copied == 0 && counters.live_capacity == 0);
+    }
+}
+
+void Test17() {
+    struct ThrowingMove {
+        ThrowingMove() = default;
+        ThrowingMove(const ThrowingMove&) = default;
+        ThrowingMove(ThrowingMove&&) {
+        }
+        std::string payload;
+    };
+    struct CopyOnly {
+        CopyOnly() = default;
+        CopyOnly(const CopyOnly&) = default;
+        std::string payload;
+    };
+    static_assert(relocates_by_copy_v<ThrowingMove>);
+    static_assert(!relocates_by_copy_v<Obj>);
+    static_assert(!relocates_by_copy_v<std::string>);
+    static_assert(!relocates_by_copy_v<std::unique_ptr<int>>);
+    static_assert(!relocates_by_copy_v<int>);
+    // объявленный конструктор копирования подавляет неявный конструктор перемещения
+    static_assert(relocates_by_copy_v<CopyOnly>);
+    // тривиально перемещаемые типы переносятся побайтово, даже если перемещение может выбросить исключение
+    static_assert(!relocates_by_copy_v<Relocatable>);
+}
+
+void Test18() {
+    struct Point {
+        double x;
+        double y;
+        int id;
+    };
+    const std::string path = (std::filesystem::temp_directory_path() / "advanced_vector_test18.bin").string();
+    std::filesystem::remove(path);
+    const size_t SIZE = 10000;
+    {
+        MappedVector<Point> v(path);
+        assert(v.IsOpen() && v.Size() == 0 && v.Capacity() == 0);
+        v.Advise(AccessPattern::Sequential);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(Point{i * 0.5, i * 2.0, static_cast<int>(i)});
+        }
+        assert(v.Size() == SIZE && v.Capacity() >= SIZE);
+        v.PushBack(v[0]);
+        v.PopBack();
+        v.Flush();
+    }
+    {
+        // данные переживают закрытие файла
+        MappedVector<Point> v(path);
+        assert(v.Size() == SIZE);
+        v.Advise(AccessPattern::Random);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i].id == static_cast<int>(i) && v[i].y == i * 2.0);
+        }
+        assert(std::all_of(v.begin(), v.end(), [](const Point& p) {
+            return p.x * 4 == p.y;
+        }));
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE);
+        // аргумент ссылается на элемент, а рост переотображает файл
+        v.EmplaceBack(v[1]);
+        assert(v.Capacity() > SIZE && v[SIZE].id == 1 && v[SIZE].y == 2.0);
+        v.PopBack();
+        v.ShrinkToFit();
+        const Point extra[] = {{1, 4, -1}, {2, 8, -2}};
+        v.Append(std::begin(extra), std::end(extra));
+        v.Resize(SIZE + 3);
+        assert(v[SIZE].id == -1 && v[SIZE + 1].id == -2 && v[SIZE + 2].id == 0);
+        v.Resize(5);
+        MappedVector<Point> moved(std::move(v));
+        assert(!v.IsOpen() && v.Size() == 0 && moved.Size() == 5);
+        moved.Close();
+        assert(!moved.IsOpen());
+    }
+    {
+        MappedVector<Point> v;
+        v.Open(path);
+        assert(v.Size() == 5 && v[4].id == 4);
+        v.Clear();
+    }
+    try {
+        MappedVector<int> wrong_type(path);
+        assert(false);
+    } catch (const std::runtime_error&) {
+    }
+    std::filesystem::remove(path);
+}
+
+void Test19() {
+    using ReallocatingVector = Vector<int, ReallocatingAllocator<int>>;
+    static_assert(detail::HasReallocate<ReallocatingAllocator<int>>::value);
+    static_assert(!detail::HasReallocate<std::allocator<int>>::value);
+    const int SIZE = 1000;
+    {
+        ReallocatingAllocator<int>::ResetCounters();
+        ReallocatingVector v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.PushBack(i);
+        }
+        // первый буфер выделяется allocate, дальше он только расширяется
+        assert(ReallocatingAllocator<int>::num_allocate == 1);
+        assert(ReallocatingAllocator<int>::num_reallocate == 10);
+        v.Reserve(SIZE * 4);
+        v.Resize(SIZE / 2);
+        v.ShrinkToFit();
+        assert(ReallocatingAllocator<int>::num_allocate == 1 && ReallocatingAllocator<int>::num_reallocate == 12);
+        assert(v.Capacity() == SIZE / 2);
+        // вставка в середину и элемент самого вектора в качестве аргумента
+        v.Insert(v.cbegin() + 1, v[0]);
+        v.Emplace(v.cbegin() + 3, v.Size());
+        assert(v.Size() == SIZE / 2 + 2 && v[0] == 0 && v[1] == 0 && v[2] == 1 && v[3] == SIZE / 2 + 1);
+        assert(v[4] == 2 && v.end()[-1] == SIZE / 2 - 1);
+        // неудачное расширение не меняет вектор
+        v.ShrinkToFit();
+        ReallocatingAllocator<int>::reallocate_throws = true;
+        try {
+            v.PushBack(-1);
+            assert(false);
+        } catch (const std::bad_alloc&) {
+        }
+        assert(v.Size() == SIZE / 2 + 2 && v.Capacity() == v.Size() && v.end()[-1] == SIZE / 2 - 1);
+        ReallocatingAllocator<int>::reallocate_throws = false;
+    }
+    {
+        // элементы, не являющиеся тривиально перемещаемыми, переносятся обычным способом
+        ReallocatingAllocator<std::string>::ResetCounters();
+        Vector<std::string, ReallocatingAllocator<std::string>> v;
+        for (int i = 0; i < 10; ++i) {
+            v.PushBack(std::to_string(i));
+        }
+        assert(ReallocatingAllocator<std::string>::num_reallocate == 0 && v[9] == "9");
+    }
+    {
+        // блоки от 64 КБ отображаются mmap и растут через mremap
+        Vector<int, HugePageAllocator<int, 64 * 1024>> v;
+        const int BIG_SIZE = 1 << 20;
+        for (int i = 0; i < BIG_SIZE; ++i) {
+            v.PushBack(i);
+        }
+        for (int i = 0; i < BIG_SIZE; i += 997) {
+            assert(v[i] == i);
+        }
+        v.Resize(100);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 100 && v[99] == 99);
+        HugePageVector<int> big(BIG_SIZE);
+        assert(big[BIG_SIZE - 1] == 0);
+    }
+    {
+        // блок, которому некуда расти на месте, переносится с сохранением выравнивания по большой странице
+        using Alloc = HugePageAllocator<char>;
+        const size_t PAGE = Alloc::HUGE_PAGE_SIZE;
+        Alloc alloc;
+        char* block = alloc.allocate(PAGE);
+        assert(reinterpret_cast<std::uintptr_t>(block) % PAGE == 0);
+        block[PAGE - 1] = 'x';
+        // занимаем адреса сразу за блоком (если они уже заняты, рост на месте невозможен и так)
+        void* guard = ::mmap(block + PAGE, 4096, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+        block = alloc.reallocate(block, PAGE, PAGE * 2);
+        assert(reinterpret_cast<std::uintptr_t>(block) % PAGE == 0 && block[PAGE - 1] == 'x');
+        block[PAGE * 2 - 1] = 'y';
+        alloc.deallocate(block, PAGE * 2);
+        if (guard != MAP_FAILED) {
+            ::munmap(guard, 4096);
+        }
+    }
+}
+
+void Test20() {
+    const ParallelPolicy policy{4, 4096};
+    assert(policy.ChunkCount(10, sizeof(int)) == 1);
+    assert(policy.ChunkCount(1 << 20, sizeof(int)) == 4);
+    const size_t SIZE = 1 << 20;
+    {
+        Vector<int> v(policy, SIZE);
+        assert(v.Size() == SIZE && v.Capacity() == SIZE);
+        assert(std::all_of(v.begin(), v.end(), [](int x) {
+            return x == 0;
+        }));
+        std::iota(v.begin(), v.end(), 0);
+        Vector<int> copy(policy, v);
+        assert(copy.Size() == SIZE && std::equal(v.begin(), v.end(), copy.begin()));
+        // value — элемент этого же вектора, буфер перевыделяется
+        copy.Resize(policy, SIZE * 3, copy[5]);
+        assert(copy.Size() == SIZE * 3 && copy[SIZE - 1] == static_cast<int>(SIZE - 1));
+        assert(std::all_of(copy.begin() + SIZE, copy.end(), [](int x) {
+            return x == 5;
+        }));
+        copy.Resize(policy, SIZE / 2);
+        copy.Resize(policy, SIZE);
+        assert(copy[SIZE / 2 - 1] == static_cast<int>(SIZE / 2 - 1) && copy[SIZE / 2] == 0);
+    }
+    {
+        Vector<std::string> v;
+        v.Resize(SIZE / 16, "string long enough to be allocated on the heap");
+        const Vector<std::string> copy(policy, v);
+        assert(copy.Size() == v.Size() && std::equal(v.begin(), v.end(), copy.begin()));
+    }
+    {
+        // исключение в одном из кусков: созданные куски разрушаются, вектор не меняется
+        Vector<Counted> v(policy, SIZE / 4);
+        assert(Counted::num_alive == static_cast<int>(SIZE / 4));
+        Counted::num_constructions = 0;
+        Counted::construction_throw_at = static_cast<int>(SIZE / 8);
+        try {
+            v.Resize(policy, SIZE);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == SIZE / 4 && Counted::num_alive == static_cast<int>(SIZE / 4));
+        try {
+            Counted::num_constructions = 0;
+            Vector<Counted> failed(policy, SIZE);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(Counted::num_alive == static_cast<int>(SIZE / 4));
+        Counted::construction_throw_at = 0;
+    }
+    assert(Counted::num_alive == 0);
+}
+
+void Test21() {
+    const int THREADS = 8;
+    const int PER_THREAD = 10000;
+    {
+        ConcurrentVector<std::pair<int, int>> v;
+        const auto& first = v.EmplaceBack(-1, -1);
+        std::vector<std::thread> producers;
+        std::atomic<bool> stable_references = true;
+        for (int t = 0; t < THREADS; ++t) {
+            producers.emplace_back([&v, &stable_references, t] {
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    auto& value = v.EmplaceBack(t, i);
+                    if (value.first != t || value.second != i) {
+                        stable_references = false;
+                    }
+                }
+            });
+        }
+        // читатель обходит снимки, пока производители добавляют элементы
+        size_t last_seen = 0;
+        while (last_seen < THREADS * PER_THREAD + 1) {
+            const auto snapshot = v.GetSnapshot();
+            assert(snapshot.Size() >= last_seen);
+            last_seen = snapshot.Size();
+            for (const auto& value : snapshot) {
+                assert(value.first >= -1 && value.first < THREADS);
+            }
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        assert(stable_references && &first == &v[0] && first.first == -1);
+        assert(v.Size() == THREADS * PER_THREAD + 1 && v.PublishedSize() == v.Size());
+        // элементы каждого производителя идут в порядке добавления
+        std::vector<int> next(THREADS, 0);
+        for (const auto& [t, i] : v.GetSnapshot()) {
+            if (t >= 0) {
+                assert(next[t] == i);
+                ++next[t];
+            }
+        }
+        assert(std::all_of(next.begin(), next.end(), [](int n) {
+            return n == PER_THREAD;
+        }));
+    }
+    {
+        // позиция, конструктор элемента которой выбросил исключение, пропускается при обходе
+        Counted::num_constructions = 0;
+        Counted::construction_throw_at = 2;
+        ConcurrentVector<Counted> v;
+        v.EmplaceBack();
+        try {
+            v.EmplaceBack();
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        Counted::construction_throw_at = 0;
+        v.EmplaceBack().value = 9;
+        assert(v.Size() == 3 && v.PublishedSize() == 3 && !v.IsReady(1) && v.IsReady(2));
+        const auto snapshot = v.GetSnapshot();
+        assert(std::distance(snapshot.begin(), snapshot.end()) == 2);
+        assert(std::next(snapshot.begin()).Index() == 2 && std::next(snapshot.begin())->value == 9);
+        assert(Counted::num_alive == 2);
+    }
+    assert(Counted::num_alive == 0);
+}
+
+void Test22() {
+    using namespace std::literals;
+    const size_t SIZE = 1000;
+    using ObjVector = StableVector<Obj, std::allocator<Obj>, 16>;
+    {
+        Obj::ResetCounters();
+        ObjVector v;
+        const Obj& first = v.EmplaceBack(0, "first object name long enough for the heap"s);
+        const auto first_it = v.begin();
+        for (size_t i = 1; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        // добавление не перемещает и не копирует элементы
+        assert(Obj::num_moved == 0 && Obj::num_copied == 0);
+        assert(&first == &v[0] && &*first_it == &first);
+        assert(v.Size() == SIZE && v.Capacity() == (SIZE + 15) / 16 * 16);
+        // аргумент может ссылаться на элемент самого вектора
+        v.PushBack(v[SIZE - 1]);
+        assert(v[SIZE].id == static_cast<int>(SIZE - 1) && Obj::num_copied == 1);
+        v.PopBack();
+        assert(std::distance(v.begin(), v.end()) == static_cast<std::ptrdiff_t>(SIZE));
+        assert(v.begin()[17].id == 17);
+        assert(std::is_sorted(v.begin(), v.end(), [](const Obj& lhs, const Obj& rhs) {
+            return lhs.id < rhs.id;
+        }));
+        ObjVector::const_iterator cit = v.begin() + 5;
+        assert(cit->id == 5 && (v.cend() - cit) == static_cast<std::ptrdiff_t>(SIZE - 5));
+
+        size_t chunks = 0;
+        int id_sum = 0;
+        std::as_const(v).ForEachChunk([&](const Obj* data, size_t count) {
+            ++chunks;
+            for (size_t i = 0; i < count; ++i) {
+                id_sum += data[i].id;
+            }
+        });
+        assert(chunks == (SIZE + 15) / 16 && id_sum == static_cast<int>(SIZE * (SIZE - 1) / 2));
+
+        ObjVector copy(v);
+        assert(copy.Size() == SIZE && copy[SIZE - 1].id == static_cast<int>(SIZE - 1));
+        assert(first.name == "first object name long enough for the heap"s);
+        v.Resize(10);
+        v.ShrinkToFit();
+        assert(v.Size() == 10 && v.Capacity() == 16 && &first == &v[0]);
+        copy = v;
+        assert(copy.Size() == 10);
+        ObjVector moved(std::move(copy));
+        assert(moved.Size() == 10 && copy.Size() == 0);
+        copy = std::move(moved);
+        assert(copy.Size() == 10 && moved.Size() == 0);
+        v.ClearAndRelease();
+        assert(v.Size() == 0 && v.Capacity() == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // исключение при Resize: созданные элементы удаляются, вектор не меняется
+        ObjVector v(20);
+        Obj::default_construction_throw_countdown = 30;
+        try {
+            v.Resize(100);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 20 && Obj::GetAliveObjectCount() == 20);
+        v.Resize(30, v[3]);
+        assert(v.Size() == 30 && v[29].id == v[3].id);
+        v.Reserve(1000);
+        assert(v.Capacity() == 1008);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        StableVector<int> v;
+        static_assert(StableVector<int>::CHUNK_SIZE == 1024);
+        for (int i = 0; i < 5000; ++i) {
+            v.PushBack(i);
+        }
+        std::sort(v.begin(), v.end(), std::greater<>());
+        assert(v[0] == 4999 && v[4999] == 0);
+    }
+}
+
+void Test23() {
+    using namespace std::literals;
+    {
+        SoaVector<int, double, std::string> v;
+        for (int i = 0; i < 100; ++i) {
+            v.EmplaceBack(i, i * 0.5, std::to_string(i));
+        }
+        assert(v.Size() == 100 && v.Capacity() == 128);
+        // столбцы — плоские непрерывные массивы
+        const ColumnSpan<const double> values = std::as_const(v).Column<1>();
+        assert(values.Size() == 100 && &values[99] - &values[0] == 99);
+        assert(std::accumulate(values.begin(), values.end(), 0.0) == 99 * 100 / 4.0);
+        const auto ids = v.Column<0>();
+        assert(std::accumulate(ids.begin(), ids.end(), 0) == 99 * 100 / 2);
+        // строки изменяются через кортеж ссылок
+        for (auto [id, value, name] : v) {
+            value = id;
+            name += "!"s;
+        }
+        const auto [id, value, name] = std::as_const(v)[42];
+        assert(id == 42 && value == 42.0 && name == "42!"s);
+        assert(std::get<2>(*(v.begin() + 7)) == "7!"s && v.end() - v.begin() == 100);
+        const auto row7 = 7 + std::as_const(v).begin();
+        assert(row7 > v.cbegin() && row7 <= row7 && v.cend() >= row7 && !(row7 >= v.cend()));
+        assert(std::get<0>(row7[1]) == 8 && row7 - 7 == v.cbegin());
+        // аргумент может ссылаться на элемент самого вектора, в том числе при росте
+        v.ShrinkToFit();
+        v.EmplaceBack(std::get<0>(v[0]), 1.0, std::get<2>(v[99]));
+        assert(v.Size() == 101 && std::get<2>(v[100]) == "99!"s);
+        v.PopBack();
+
+        SoaVector<int, double, std::string> copy(v);
+        assert(copy.Size() == 100 && std::get<2>(copy[5]) == "5!"s);
+        v.Resize(10);
+        copy = v;
+        assert(copy.Size() == 10 && copy.Capacity() == 10);
+        SoaVector<int, double, std::string> moved(std::move(copy));
+        assert(moved.Size() == 10 && copy.Size() == 0);
+        v.Clear();
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0);
+        v.Resize(3);
+        assert(std::get<0>(v[2]) == 0 && std::get<2>(v[2]).empty());
+    }
+    {
+        // Может выбросить исключение при копировании, перемещается копированием
+        struct Fragile {
+            Fragile() = default;
+            Fragile(const Fragile& other)
+                : fail(other.fail) {
+                if (fail) {
+                    throw std::runtime_error("copy failed");
+                }
+            }
+            Fragile& operator=(const Fragile&) = default;
+            bool fail = false;
+        };
+        static_assert(relocates_by_copy_v<Fragile>);
+        const std::string long_name = "a string long enough to live on the heap"s;
+        SoaVector<std::string, Fragile> v;
+        v.EmplaceBack(long_name, Fragile{});
+        v.EmplaceBack(long_name, Fragile{});
+        std::get<1>(v[1]).fail = true;
+        // при исключении во время переноса в новый буфер столбцы остаются прежними
+        try {
+            v.EmplaceBack(long_name, Fragile{});
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 2 && v.Capacity() == 2);
+        assert(std::get<0>(v[0]) == long_name && std::get<0>(v[1]) == long_name);
+        try {
+            v.Reserve(10);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Capacity() == 2 && std::get<0>(v[1]) == long_name);
+        std::get<1>(v[1]).fail = false;
+        v.Reserve(10);
+        assert(v.Capacity() == 10 && std::get<0>(v[1]) == long_name);
+    }
+    {
+        // исключение при Resize: созданные поля удаляются, вектор не меняется
+        SoaVector<Obj, int> v(20);
+        Obj::default_construction_throw_countdown = 30;
+        try {
+            v.Resize(100);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 20 && Obj::GetAliveObjectCount() == 20);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test24() {
+    using namespace std::literals;
+#if VECTOR_CHECK_LEVEL >= 1
+    {
+        Vector<int> v(5);
+        const std::string message = CheckFailureMessage([&] {
+            static_cast<void>(v[5]);
+        });
+        assert(message.find("vector check failed: index 5 out of range for size 5"s) != std::string::npos);
+        assert(CheckFailureMessage([&] {
+                   v.Erase(v.end());
+               }).find("position 5 outside [0, 5)"s)
+               != std::string::npos);
+        // итератор другого вектора
+        Vector<int> other(3);
+        assert(!CheckFailureMessage([&] {
+                    v.Emplace(other.begin(), 1);
+                }).empty());
+        assert(CheckFailureMessage([&] {
+                   v.Erase(v.begin() + 3, v.begin() + 2);
+               }).find("range [3, 2)"s)
+               != std::string::npos);
+        // корректные обращения проверки не задевают
+        assert(CheckFailureMessage([&] {
+                   v.Erase(v.Emplace(v.end(), 1));
+                   static_cast<void>(v[4]);
+               }).empty());
+    }
+    {
+        SmallVector<int, 4> small(2);
+        assert(!CheckFailureMessage([&] {
+                    static_cast<void>(small[2]);
+                }).empty());
+        StableVector<int> stable;
+        assert(CheckFailureMessage([&] {
+                   stable.PopBack();
+               }).find("PopBack on empty vector"s)
+               != std::string::npos);
+        SoaVector<int, double> soa;
+        assert(!CheckFailureMessage([&] {
+                    static_cast<void>(soa[0]);
+                }).empty());
+    }
+#endif
+    {
+        Vector<int> v;
+        const size_t generation = v.Generation();
+        v.Reserve(10);
+#if VECTOR_CHECK_LEVEL >= 2 || defined(VECTOR_CHECKED_ITERATORS)
+        // поколение меняется вместе с буфером
+        assert(v.Generation() != generation);
+        const size_t reserved = v.Generation();
+        v.PushBack(1);
+        assert(v.Generation() == reserved);
+        v.ShrinkToFit();
+        assert(v.Generation() != reserved);
+#elif !defined(VECTOR_CHECKED_ITERATORS)
+        // без полных проверок счётчик не хранится
+        assert(v.Generation() == generation && generation == 0);
+        static_assert(sizeof(Vector<int>) == sizeof(RawMemory<int>) + sizeof(size_t));
+#endif
+    }
+}
+
+void Test25() {
+#if VECTOR_CHECK_LEVEL >= 2
+    // полные проверки включают отслеживание итераторов
+    static_assert(std::is_same_v<Vector<int>::iterator, CheckedIterator<int>>);
+#endif
+#ifdef VECTOR_CHECKED_ITERATORS
+    static_assert(std::is_same_v<Vector<int>::iterator, CheckedIterator<int>>);
+#ifdef __cpp_lib_concepts
+    static_assert(std::contiguous_iterator<Vector<int>::iterator>);
+    static_assert(std::contiguous_iterator<Vector<int>::const_iterator>);
+#endif
+    {
+        Vector<int> v;
+        v.Reserve(2);
+        v.PushBack(1);
+        const auto it = v.begin();
+        // добавление без перевыделения итератор не портит
+        v.PushBack(2);
+        assert(it.IsValid() && *it == 1);
+        const Vector<int>::const_iterator cit = it;
+        assert(cit == v.cbegin() && v.end() - cit == 2);
+        v.PushBack(3);
+        assert(!it.IsValid() && v.begin().IsValid());
+        assert(CheckFailureMessage([&] {
+                   static_cast<void>(*it);
+               }).find("used after its vector changed buffer")
+               != std::string::npos);
+        // сравнение и сдвиг устаревшего итератора разрешены
+        assert(it != v.begin());
+
+        std::iota(v.begin(), v.end(), 0);
+        std::sort(v.begin(), v.end(), std::greater<>());
+        assert(v[0] == 2 && v[2] == 0);
+        assert(std::find(v.cbegin(), v.cend(), 1) - v.cbegin() == 1);
+#ifdef __cpp_lib_concepts
+        assert(std::to_address(v.end()) == v.Data() + v.Size());
+#endif
+    }
+#else
+    // без VECTOR_CHECKED_ITERATORS итераторы остаются указателями
+    static_assert(std::is_same_v<Vector<int>::iterator, int*>);
+    static_assert(std::is_same_v<Vector<int>::const_iterator, const int*>);
+    Vector<int> v(3);
+    assert(v.begin() == v.Data() && std::as_const(v).Data() == v.cbegin());
+#endif
+}
+
+void Test26() {
+    using vector_simd::SimdLevel;
+    const SimdLevel detected = vector_simd::DetectedSimdLevel();
+    assert(vector_simd::CurrentSimdLevel() == detected);
+    // каждый доступный вариант ядер даёт те же результаты
+    for (SimdLevel level : {SimdLevel::Baseline, SimdLevel::Avx2, SimdLevel::Avx512}) {
+        if (vector_simd::SetSimdLevel(level) != level) {
+            continue;
+        }
+        CheckSimdOperations<int>();
+        CheckSimdOperations<float>();
+        CheckSimdOperations<double>();
+        CheckSimdOperations<uint64_t>();
+        CheckSimdOperations<int8_t>();
+        CheckSimdOperations<uint16_t>();
+    }
+    vector_simd::SetSimdLevel(SimdLevel::Avx512);
+    assert(vector_simd::CurrentSimdLevel() == detected);
+    {
+        // переполнение целой суммы определено: 64-битное накопление
+        Vector<int> v;
+        v.Resize(1000);
+        vector_simd::Fill(v, std::numeric_limits<int>::max());
+        assert(vector_simd::Sum(v) == int64_t{1000} * std::numeric_limits<int>::max());
+        Vector<float> values;
+        values.Resize(1 << 12);
+        vector_simd::Fill(values, 0.5f);
+        assert(vector_simd::Sum(values) == 2048.0f);
+        // -0.0 == 0.0, а NaN не равен себе
+        Vector<double> zeros(3), negative_zeros(3);
+        vector_simd::Fill(negative_zeros, -0.0);
+        assert(zeros == negative_zeros);
+        negative_zeros[1] = std::numeric_limits<double>::quiet_NaN();
+        assert(negative_zeros != negative_zeros);
+    }
+    {
+        // столбец SoaVector обрабатывается теми же ядрами
+        SoaVector<int, float> rows;
+        for (int i = 0; i < 100; ++i) {
+            rows.EmplaceBack(i, 1.0f);
+        }
+        const auto ids = rows.Column<0>();
+        assert(vector_simd::Sum(ids.Data(), ids.Size()) == 4950);
+        Vector<float> weights;
+        vector_simd::CopyFrom(weights, rows.Column<1>());
+        assert(weights.Size() == 100 && vector_simd::Sum(weights) == 100.0f);
+    }
+}
+
+void Test27() {
+    struct Sample {
+        uint32_t id;
+        float value;
+        double weight;
+    };
+    Vector<Sample> samples;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        samples.PushBack({i, i * 0.5f, i * 2.0});
+    }
+    const auto make_file = [] {
+        std::FILE* file = std::tmpfile();
+        assert(file != nullptr);
+        return file;
+    };
+    {
+        // сигнатура в начале сообщения совпадает с документированной
+        char magic[sizeof(vector_wire::MAGIC)];
+        std::memcpy(magic, &vector_wire::MAGIC, sizeof(magic));
+        assert(std::memcmp(magic, "ADDVEWR1", sizeof(magic)) == 0);
+    }
+    {
+        // запись и чтение через дескриптор
+        std::FILE* file = make_file();
+        const int fd = fileno(file);
+        vector_wire::WriteTo(fd, samples);
+        vector_wire::WriteTo(fd, Vector<Sample>());
+        assert(lseek(fd, 0, SEEK_END) == static_cast<off_t>(vector_wire::MessageSize<Sample>(1000) + vector_wire::HEADER_SIZE));
+        lseek(fd, 0, SEEK_SET);
+        const Vector<Sample> received = vector_wire::ReadFrom<Sample>(fd);
+        assert(received.Size() == 1000 && received.Capacity() == 1000);
+        assert(std::memcmp(received.Data(), samples.Data(), 1000 * sizeof(Sample)) == 0);
+        assert(vector_wire::ReadFrom<Sample>(fd).Size() == 0);
+        // конец потока
+        try {
+            vector_wire::ReadFrom<Sample>(fd);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        // другой тип элементов
+        lseek(fd, 0, SEEK_SET);
+        try {
+            vector_wire::ReadFrom<int>(fd);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        // повреждённый элемент
+        lseek(fd, vector_wire::HEADER_SIZE + 100, SEEK_SET);
+        const char garbage = 0x5a;
+        assert(write(fd, &garbage, 1) == 1);
+        lseek(fd, 0, SEEK_SET);
+        try {
+            vector_wire::ReadFrom<Sample>(fd);
+            assert(false);
+        } catch (const std::runtime_error& e) {
+            assert(std::string(e.what()).find("checksum") != std::string::npos);
+        }
+        // заголовок с огромным числом элементов: обрыв обнаруживается до выделения памяти
+        vector_wire::Header huge = vector_wire::MakeHeader(samples.Data(), 0);
+        huge.count = uint64_t{1} << 40;
+        lseek(fd, 0, SEEK_SET);
+        assert(write(fd, &huge, sizeof(huge)) == static_cast<ssize_t>(sizeof(huge)));
+        lseek(fd, 0, SEEK_SET);
+        try {
+            vector_wire::ReadFrom<Sample>(fd);
+            assert(false);
+        } catch (const std::runtime_error& e) {
+            assert(std::string(e.what()).find("end of stream") != std::string::npos);
+        }
+        std::fclose(file);
+    }
+    {
+        // из канала элементы читаются частями по мере поступления
+        int fds[2];
+        assert(pipe(fds) == 0);
+        Vector<Sample> many;
+        for (uint32_t i = 0; i < 200'000; ++i) {
+            many.PushBack({i, 1.0f, 2.0});
+        }
+        std::thread writer([&] {
+            vector_wire::WriteTo(fds[1], many);
+            vector_wire::Header huge = vector_wire::MakeHeader(many.Data(), 0);
+            huge.count = uint64_t{1} << 40;
+            assert(write(fds[1], &huge, sizeof(huge)) == static_cast<ssize_t>(sizeof(huge)));
+            char padding[vector_wire::HEADER_SIZE - sizeof(huge) + 100] = {};
+            assert(write(fds[1], padding, sizeof(padding)) == static_cast<ssize_t>(sizeof(padding)));
+            close(fds[1]);
+        });
+        const Vector<Sample> received = vector_wire::ReadFrom<Sample>(fds[0]);
+        assert(received.Size() == many.Size() && received.Capacity() == many.Size());
+        assert(std::memcmp(received.Data(), many.Data(), many.Size() * sizeof(Sample)) == 0);
+        try {
+            vector_wire::ReadFrom<Sample>(fds[0]);
+            assert(false);
+        } catch (const std::runtime_error& e) {
+            assert(std::string(e.what()).find("end of stream") != std::string::npos);
+        }
+        writer.join();
+        close(fds[0]);
+    }
+    {
+        // сообщение в памяти разбирается без копирования
+        Vector<uint64_t> storage((vector_wire::MessageSize<Sample>(1000) + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+        const vector_wire::Header header = vector_wire::MakeHeader(samples.Data(), samples.Size());
+        std::memcpy(storage.Data(), &header, sizeof(header));
+        std::memcpy(reinterpret_cast<char*>(storage.Data()) + vector_wire::HEADER_SIZE, samples.Data(),
+                    samples.Size() * sizeof(Sample));
+        const size_t message_size = vector_wire::MessageSize<Sample>(1000);
+        const auto view = VectorView<Sample>::FromMessage(storage.Data(), message_size);
+        assert(view.Size() == 1000 && view[999].id == 999 && view.end() - view.begin() == 1000);
+        assert(reinterpret_cast<const char*>(view.Data())
+               == reinterpret_cast<const char*>(storage.Data()) + vector_wire::HEADER_SIZE);
+        const Vector<Sample> copy = view.ToVector();
+        assert(copy.Size() == 1000 && copy[10].weight == 20.0);
+        try {
+            VectorView<Sample>::FromMessage(storage.Data(), message_size - 1);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        const VectorView<Sample> whole(samples);
+        assert(whole.Data() == samples.Data() && whole.Size() == samples.Size());
+    }
+    {
+        // передача владения внешним буфером
+        std::allocator<int> alloc;
+        int* buffer = alloc.allocate(16);
+        for (int i = 0; i < 10; ++i) {
+            buffer[i] = i;
+        }
+        Vector<int> v(RawMemory<int>::Adopt(buffer, 16), 10);
+        assert(v.Data() == buffer && v.Size() == 10 && v.Capacity() == 16 && v[9] == 9);
+        v.PushBack(10);
+        assert(v.Data() == buffer);
+        auto [memory, size] = v.ReleaseBuffer();
+        assert(v.Size() == 0 && v.Capacity() == 0 && size == 11 && memory.Capacity() == 16);
+        int* released = memory.Release();
+        assert(released == buffer && memory.Capacity() == 0 && memory.GetAddress() == nullptr);
+        alloc.deallocate(released, 16);
+    }
+}
+
+void Test28() {
+    struct Record {
+        uint64_t key;
+        uint32_t value;
+        uint16_t flags;
+    };
+    static_assert(sizeof(Record) == 16);
+    const size_t COUNT = 10000;
+    Vector<Record> records;
+    for (size_t i = 0; i < COUNT; ++i) {
+        records.PushBack({i, static_cast<uint32_t>(i * 3), static_cast<uint16_t>(i % 7)});
+    }
+    const auto same_records = [&records](const Vector<Record>& v, size_t offset) {
+        for (size_t i = 0; i < records.Size(); ++i) {
+            const Record& r = v[offset + i];
+            if (r.key != records[i].key || r.value != records[i].value || r.flags != records[i].flags) {
+                return false;
+            }
+        }
+        return true;
+    };
+    vector_stream::StreamOptions options;
+    options.chunk_bytes = 1000;  // не кратен размеру записи
+    {
+        // обычный файл: буфер резервируется один раз под весь файл
+        std::FILE* file = std::tmpfile();
+        const int fd = fileno(file);
+        vector_stream::WriteAll(fd, records, options);
+        lseek(fd, 0, SEEK_SET);
+        Vector<Record> loaded;
+        loaded.PushBack({});
+        assert(vector_stream::ReadAll(fd, loaded, options) == COUNT);
+        assert(loaded.Size() == COUNT + 1 && loaded.Capacity() == COUNT + 1);
+        assert(same_records(loaded, 1));
+        // неполная последняя запись
+        const char tail[5] = {};
+        assert(write(fd, tail, sizeof(tail)) == static_cast<ssize_t>(sizeof(tail)));
+        lseek(fd, 0, SEEK_SET);
+        Vector<Record> truncated;
+        try {
+            vector_stream::ReadAll(fd, truncated, options);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(truncated.Size() == COUNT);
+        std::fclose(file);
+    }
+    {
+        // канал: записи приходят частями произвольной длины
+        int fds[2];
+        assert(pipe(fds) == 0);
+        std::thread writer([&] {
+            const auto* bytes = reinterpret_cast<const char*>(records.Data());
+            size_t remaining = COUNT * sizeof(Record);
+            for (size_t step = 1; remaining > 0; step = step % 97 + 13) {
+                const size_t n = std::min(step, remaining);
+                assert(write(fds[1], bytes, n) == static_cast<ssize_t>(n));
+                bytes += n;
+                remaining -= n;
+            }
+            close(fds[1]);
+        });
+        Vector<Record> received;
+        vector_stream::ChunkedReader<Record> reader(fds[0], options);
+        size_t chunks = 0;
+        while (reader.ReadChunk(received) != 0) {
+            ++chunks;
+        }
+        writer.join();
+        close(fds[0]);
+        assert(reader.Eof() && received.Size() == COUNT && chunks > 0);
+        assert(same_records(received, 0));
+    }
+    {
+        std::stringstream stream;
+        vector_stream::WriteAll(stream, records, options);
+        assert(stream.str().size() == COUNT * sizeof(Record));
+        Vector<Record> loaded;
+        assert(vector_stream::ReadAll(stream, loaded, options) == COUNT);
+        assert(same_records(loaded, 0));
+        std::stringstream broken(std::string(sizeof(Record) * 2 + 3, 'x'));
+        try {
+            vector_stream::ReadAll(broken, loaded, options);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+    }
+    {
+        // память хвоста доступна до CommitAppend, размер меняется только им
+        Vector<int> v;
+        int* tail = v.PrepareAppend(3);
+        assert(v.Size() == 0 && v.Capacity() >= 3);
+        tail[0] = 1;
+        tail[1] = 2;
+        v.CommitAppend(2);
+        assert(v.Size() == 2 && v[1] == 2);
+    }
+}
+
+void Test29() {
+    const size_t SIZE = 10;
+    {
+        // тривиально переносимые: хвост сдвигается memmove, аргумент может ссылаться на сдвигаемый элемент
+        Vector<int> v;
+        v.Reserve(SIZE + 2);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        v.Insert(v.cbegin() + 1, v[5]);
+        v.Insert(v.cbegin() + 4, v[v.Size() - 1]);
+        assert(v.Capacity() == SIZE + 2);
+        const int expected[] = {0, 5, 1, 2, 9, 3, 4, 5, 6, 7, 8, 9};
+        assert(std::equal(v.begin(), v.end(), std::begin(expected), std::end(expected)));
+    }
+    {
+        Vector<std::unique_ptr<int>> v;
+        v.Reserve(SIZE + 1);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(std::make_unique<int>(static_cast<int>(i)));
+        }
+        int* const moved = v[0].get();
+        v.Emplace(v.cbegin() + 3, new int(42));
+        assert(v[0].get() == moved && *v[3] == 42 && *v[4] == 3 && *v[SIZE] == SIZE - 1);
+    }
+    {
+        // nothrow-перемещаемые: новый элемент присваивается из временного объекта
+        Vector<std::string> v;
+        v.Reserve(SIZE + 1);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(std::string(20, static_cast<char>('a' + i)));
+        }
+        v.Insert(v.cbegin() + 2, v[7]);
+        assert(v.Size() == SIZE + 1 && v[2] == std::string(20, 'h') && v[8] == std::string(20, 'h'));
+        assert(v[3] == std::string(20, 'c') && v[SIZE] == std::string(20, 'j'));
+    }
+    {
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE + 1);
+        v[SIZE - 1].id = 77;
+        Obj::ResetCounters();
+        v.Emplace(v.cbegin() + 3, 1, "new");
+        assert(Obj::num_constructed_with_id_and_name == 1);
+        assert(Obj::num_moved == 1 && Obj::num_move_assigned == SIZE - 3);
+        assert(v[3].id == 1 && v[3].name == "new" && v[SIZE].id == 77);
+        assert(Obj::GetAliveObjectCount() == 1);
+    }
+}
+
+void Test30() {
+    {
+        // сортировка и удаление повторов при построении, сравнение с std::set
+        std::mt19937 gen(30);
+        std::uniform_int_distribution<int> dist(0, 999);
+        Vector<int> keys;
+        std::set<int> expected;
+        for (int i = 0; i < 2000; ++i) {
+            keys.PushBack(dist(gen));
+            expected.insert(keys[keys.Size() - 1]);
+        }
+        FlatSet<int> set(std::move(keys));
+        assert(set.Size() == expected.size() && std::equal(set.begin(), set.end(), expected.begin()));
+        for (int key = -1; key <= 1000; ++key) {
+            assert(set.Contains(key) == (expected.count(key) != 0));
+            assert(set.LowerBound(key) - set.begin()
+                   == std::distance(expected.begin(), expected.lower_bound(key)));
+            assert(set.UpperBound(key) - set.begin()
+                   == std::distance(expected.begin(), expected.upper_bound(key)));
+        }
+        // пакетная вставка пересекающихся и неупорядоченных ключей
+        Vector<int> batch;
+        for (int i = 0; i < 500; ++i) {
+            batch.PushBack(dist(gen) * 2 - 500);
+        }
+        set.Insert(batch.begin(), batch.end());
+        expected.insert(batch.begin(), batch.end());
+        assert(set.Size() == expected.size() && std::equal(set.begin(), set.end(), expected.begin()));
+        // дозапись по возрастанию без слияния
+        set.Insert({5000, 5001, 5001, 5002});
+        assert(set.Size() == expected.size() + 3 && *(set.end() - 1) == 5002);
+
+        assert(set.Insert(5001).second == false && set.Erase(5001) == 1 && set.Erase(5001) == 0);
+        const auto [pos, inserted] = set.Insert(4999);
+        assert(inserted && *pos == 4999 && *(pos + 1) == 5000);
+        assert(EraseIf(set, [](int key) {
+                   return key >= 4999;
+               }) == 3);
+        assert(set.Size() == expected.size() && std::equal(set.begin(), set.end(), expected.begin()));
+    }
+    {
+        FlatSet<std::string, std::greater<std::string>> set{"b", "a", "c", "a"};
+        assert(set.Size() == 3 && *set.begin() == "c" && set.Find("a") == set.end() - 1);
+        assert(set.Find("d") == set.end() && set.Count("b") == 1);
+        FlatSet<int> empty;
+        assert(empty.LowerBound(1) == empty.end() && !empty.Contains(1));
+        Vector<int> sorted_keys;
+        for (int key : {1, 3, 5}) {
+            sorted_keys.PushBack(key);
+        }
+        FlatSet<int> sorted(SORTED_UNIQUE, std::move(sorted_keys));
+        assert(sorted.Contains(3) && !sorted.Contains(2) && sorted.Size() == 3);
+    }
+    {
+        // отображение: первая пара для повторяющегося ключа, ключи и значения в отдельных массивах
+        FlatMap<int, std::string> map{{3, "c"}, {1, "a"}, {2, "b"}, {1, "dup"}};
+        assert(map.Size() == 3 && map.At(1) == "a" && map.Keys()[0] == 1 && map.Values()[2] == "c");
+        try {
+            map.At(4);
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+        map[4] = "d";
+        assert(map.Size() == 4 && map.Find(4)->second == "d");
+        assert(!map.TryEmplace(4, "x").second && map.InsertOrAssign(4, "e").second == false && map[4] == "e");
+        int key_sum = 0;
+        for (auto [key, value] : map) {
+            key_sum += key;
+            value += "!";
+        }
+        assert(key_sum == 10 && map.At(2) == "b!");
+        assert(map.Erase(2) == 1 && !map.Contains(2) && map.Erase(map.Find(1))->first == 3);
+        const FlatMap<int, std::string>& cmap = map;
+        assert(cmap.Find(3)->second == "c!" && cmap.LowerBound(0) == cmap.begin());
+        // полный набор операций итератора произвольного доступа, итераторы разных отображений не равны
+        const auto first = map.begin();
+        const auto second = 1 + first;
+        assert(second > first && first <= second && second >= second && !(first >= second));
+        assert(second - 1 == first && second[0].first == 4 && second == cmap.end() - 1);
+        FlatMap<int, std::string> other = map;
+        assert(other.begin() != map.begin());
+    }
+    {
+        // пакетная вставка со слиянием, сравнение с std::map
+        std::mt19937 gen(31);
+        std::uniform_int_distribution<int> dist(0, 299);
+        FlatMap<int, int> map;
+        std::map<int, int> expected;
+        for (int round = 0; round < 5; ++round) {
+            Vector<std::pair<int, int>> items;
+            for (int i = 0; i < 100; ++i) {
+                items.PushBack({dist(gen), round * 1000 + i});
+                expected.insert(items[items.Size() - 1]);
+            }
+            map.Insert(items.begin(), items.end());
+            assert(map.Size() == expected.size());
+            assert(std::equal(map.begin(), map.end(), expected.begin(), [](const auto& lhs, const auto& rhs) {
+                return lhs.first == rhs.first && lhs.second == rhs.second;
+            }));
+        }
+        assert(EraseIf(map, [](int key, int value) {
+                   return key % 2 == 0 || value < 0;
+               }) == static_cast<size_t>(std::count_if(expected.begin(), expected.end(), [](const auto& item) {
+                   return item.first % 2 == 0;
+               })));
+        assert(std::all_of(map.begin(), map.end(), [&expected](const auto& item) {
+            return item.first % 2 == 1 && expected.at(item.first) == item.second;
+        }));
+    }
+    {
+        // значение не построилось — ключ не остаётся в отображении
+        Obj::ResetCounters();
+        FlatMap<int, Obj> map;
+        map.TryEmplace(1, 1);
+        Obj throwing;
+        throwing.throw_on_copy = true;
+        try {
+            map.TryEmplace(0, throwing);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(map.Size() == 1 && map.Keys().Size() == map.Values().Size() && !map.Contains(0));
+        // исключение при сборе новых пар оставляет отображение нетронутым
+        std::pair<int, Obj> tail[2] = {{2, Obj(2)}, {3, Obj(3)}};
+        tail[1].second.throw_on_copy = true;
+        try {
+            map.Insert(std::begin(tail), std::end(tail));
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(map.Size() == 1 && map.Values().Size() == 1 && map.At(1).id == 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test31() {
+    const size_t SIZE = 10;
+    const int ID = 42;
+    {
+        // копии разделяют буфер, элементы копируются только при первом изменении
+        Obj::ResetCounters();
+        CowVector<Obj> v(SIZE);
+        CowVector<Obj> copy = v;
+        assert(v.UseCount() == 2 && copy.Data() == v.Data() && Obj::num_copied == 0);
+        const CowVector<Obj>& cref = copy;
+        assert(cref[3].id == 0 && Obj::num_copied == 0);
+
+        copy[3].id = ID;
+        assert(Obj::num_copied == static_cast<int>(SIZE));
+        assert(v.UseCount() == 1 && copy.UseCount() == 1 && copy.Data() != v.Data());
+        assert(v[3].id == 0 && copy[3].id == ID);
+        copy.PushBack(Obj(1));
+        copy.Erase(copy.cbegin());
+        assert(Obj::num_copied == static_cast<int>(SIZE) && copy.Size() == SIZE && copy[2].id == ID);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // снимок не видит последующих изменений вектора
+        CowVector<int> table;
+        for (int i = 0; i < 5; ++i) {
+            table.PushBack(i);
+        }
+        const auto snapshot = table.Snapshot();
+        const int* const shared = snapshot.Data();
+        assert(snapshot.UseCount() == 2 && shared == table.Data());
+        table.Emplace(table.cbegin() + 1, 100);
+        table.Resize(3);
+        assert(table.Size() == 3 && table[1] == 100);
+        assert(snapshot.Size() == 5 && snapshot.Data() == shared && snapshot[1] == 1 && snapshot.UseCount() == 1);
+        auto copy = snapshot;
+        assert(copy.UseCount() == 2 && std::equal(copy.begin(), copy.end(), snapshot.begin()));
+
+        // очистка разделённого вектора не копирует его
+        CowVector<int> other = table;
+        other.Clear();
+        assert(other.Empty() && other.UseCount() == 0 && table.Size() == 3);
+        other.PushBack(7);
+        assert(other.Size() == 1 && other.UseCount() == 1);
+        CowSnapshot<int> empty = CowVector<int>().Snapshot();
+        assert(empty.Empty() && empty.begin() == empty.end() && empty.UseCount() == 0);
+    }
+    {
+        // читатели берут снимки и копии из разных потоков, пока писатель меняет свою копию
+        CowVector<std::string> config;
+        config.PushBack("route");
+        const auto published = config.Snapshot();
+        std::atomic<bool> ok = true;
+        Vector<std::thread> readers;
+        for (int t = 0; t < 4; ++t) {
+            readers.EmplaceBack([&published, &ok] {
+                for (int i = 0; i < 10000; ++i) {
+                    const auto local = published;
+                    if (local.Size() != 1 || local[0] != "route") {
+                        ok = false;
+                    }
+                }
+            });
+        }
+        for (int i = 0; i < 1000; ++i) {
+            config.PushBack(std::to_string(i));
+        }
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        assert(ok && published.UseCount() == 1 && config.Size() == 1001);
+    }
+}
+
+constexpr int InplaceVectorConstexprSum() {
+    InplaceVector<int, 7> v{5, 1, 4};
+    v.PushBack(7);
+    v.Emplace(v.begin() + 1, 10);
+    v.Erase(v.begin() + 3);
+    v.Insert(v.end(), 2, 3);
+    if (v.TryEmplaceBack(0) == nullptr || v.TryEmplaceBack(0) != nullptr) {
+        return -1;
+    }
+    InplaceVector<int, 7> copy = v;
+    copy.UnorderedErase(copy.begin());
+    int sum = 0;
+    for (int x : copy) {
+        sum = sum * 10 + x;
+    }
+    return sum;
+}
+
+void Test32() {
+    static_assert(std::is_trivially_copyable_v<InplaceVector<int, 8>>);
+    static_assert(!std::is_trivially_copyable_v<InplaceVector<std::string, 8>>);
+    // тривиально копируемые элементы с нетривиальным конструктором по умолчанию
+    struct WithDefault {
+        int x = 7;
+    };
+    struct WithConstructor {
+        explicit WithConstructor(int x)
+            : x(x) {
+        }
+        int x;
+    };
+    static_assert(std::is_trivially_copyable_v<InplaceVector<WithDefault, 4>>);
+    static_assert(std::is_trivially_copyable_v<InplaceVector<WithConstructor, 4>>);
+    {
+        InplaceVector<WithDefault, 4> v(2);
+        v.EmplaceBack(WithDefault{3});
+        InplaceVector<WithDefault, 4> copy = v;
+        InplaceVector<WithConstructor, 4> w;
+        w.EmplaceBack(5);
+        w.Insert(w.cbegin(), WithConstructor(4));
+        const InplaceVector<WithConstructor, 4> moved = std::move(w);
+        assert(copy.Size() == 3 && copy[1].x == 7 && copy[2].x == 3);
+        assert(moved.Size() == 2 && moved[0].x == 4 && moved[1].x == 5);
+    }
+    static_assert(sizeof(InplaceVector<int, 8>) == 8 * sizeof(int) + sizeof(size_t));
+    // {5, 10, 1, 7, 3, 3, 0} без первого элемента, на место которого встал последний
+    static_assert(InplaceVectorConstexprSum() == 101733);
+    const size_t SIZE = 4;
+    {
+        Obj::ResetCounters();
+        InplaceVector<Obj, SIZE> v(2);
+        v.Emplace(v.cbegin() + 1, 1, "a");
+        assert(v.Size() == 3 && v[1].id == 1 && v[1].name == "a");
+        assert(v.TryEmplaceBack(2) != nullptr && v.TryEmplaceBack(3) == nullptr && v.Size() == SIZE);
+        try {
+            v.EmplaceBack(4);
+            assert(false);
+        } catch (const std::length_error&) {
+        }
+        try {
+            v.Insert(v.cbegin(), 1, Obj(5));
+            assert(false);
+        } catch (const std::length_error&) {
+        }
+        assert(v.Size() == SIZE && v[3].id == 2);
+
+        const int copied_before = Obj::num_copied;
+        InplaceVector<Obj, SIZE> copy = v;
+        assert(Obj::num_copied == copied_before + static_cast<int>(SIZE));
+        InplaceVector<Obj, SIZE> moved = std::move(copy);
+        assert(copy.Size() == 0 && moved.Size() == SIZE && moved[1].id == 1);
+        moved.Erase(moved.cbegin(), moved.cbegin() + 2);
+        assert(moved.Size() == 2 && moved[0].id == 0 && moved[1].id == 2);
+        moved.Swap(v);
+        assert(v.Size() == 2 && moved.Size() == SIZE);
+        assert(EraseIf(moved, [](const Obj& obj) {
+                   return obj.id == 0;
+               }) == 2);
+        moved.Resize(1);
+        v.Clear();
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        InplaceVector<std::string, SIZE> v{"a", "c"};
+        v.Insert(v.cbegin() + 1, v[1]);
+        assert(v.Size() == 3 && v[1] == "c" && v[2] == "c");
+        const std::string more[] = {"x", "y"};
+        try {
+            v.Append(std::begin(more), std::end(more));
+            assert(false);
+        } catch (const std::length_error&) {
+        }
+        assert(v.Size() == 3);
+        v.Assign(std::begin(more), std::end(more));
+        assert(v.Size() == 2 && v[0] == "x");
+    }
+}
+
+#if VECTOR_HAS_CONSTEXPR
+// Таблица CRC-32 (полином 0xEDB88320), построенная вектором при компиляции
+constexpr Vector<uint32_t> BuildCrcTable() {
+    Vector<uint32_t> table;
+    table.Reserve(256);
+    for (uint32_t byte = 0; byte < 256; ++byte) {
+        uint32_t crc = byte;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ ((crc & 1) != 0 ? 0xEDB88320u : 0);
+        }
+        table.PushBack(crc);
+    }
+    return table;
+}
+
+constexpr Vector<int> BuildOddSquares() {
+    Vector<int> v(2);
+    for (int i = 1; i <= 9; ++i) {
+        v.PushBack(i * i);
+    }
+    v.Emplace(v.begin() + 1, -1);
+    EraseIf(v, [](int x) {
+        return x % 2 == 0;
+    });
+    v.Erase(v.begin());
+    v.Insert(v.begin() + 1, 2, 7);
+    return v;
+}
+
+constexpr size_t ConstexprStringLengths() {
+    Vector<std::string> v;
+    v.PushBack("bb");
+    v.EmplaceBack(3, 'c');
+    v.Emplace(v.begin(), "a");
+    v.Insert(v.begin() + 1, v.Size(), std::string("dddd"));
+    v.Erase(v.begin() + 2);
+    Vector<std::string> copy = v;
+    copy.Resize(8, "ee");
+    v = std::move(copy);
+    v.ShrinkToFit();
+    size_t lengths = 0;
+    for (const std::string& s : v) {
+        lengths = lengths * 10 + s.size();
+    }
+    return lengths;
+}
+
+// Перемещение без noexcept: при перевыделении элементы копируются, вставка идёт общим путём
+struct ConstexprLabel {
+    constexpr ConstexprLabel(int value)
+        : value(value) {
+    }
+    constexpr ConstexprLabel(const ConstexprLabel&) = default;
+    constexpr ConstexprLabel(ConstexprLabel&& other)
+        : value(other.value) {
+    }
+    constexpr ConstexprLabel& operator=(const ConstexprLabel&) = default;
+    constexpr ConstexprLabel& operator=(ConstexprLabel&& other) {
+        value = other.value;
+        return *this;
+    }
+
+    int value;
+};
+
+constexpr int ConstexprLabelsDigits() {
+    static_assert(relocates_by_copy_v<ConstexprLabel>);
+    Vector<ConstexprLabel> v;
+    for (int i = 1; i <= 5; ++i) {
+        v.EmplaceBack(i);
+    }
+    v.Emplace(v.begin() + 2, 10);
+    v.UnorderedErase(v.begin());
+    int digits = 0;
+    for (const ConstexprLabel& label : v) {
+        digits = digits * 100 + label.value;
+    }
+    return digits;
+}
+#endif
+
+void Test33() {
+#if VECTOR_HAS_CONSTEXPR
+    constexpr auto CRC_TABLE = FreezeVector<BuildCrcTable>();
+    static_assert(CRC_TABLE.size() == 256 && CRC_TABLE[1] == 0x77073096u && CRC_TABLE[255] == 0x2D02EF8Du);
+    constexpr auto ODD_SQUARES = FreezeVector<BuildOddSquares>();
+    static_assert(ODD_SQUARES == std::array<int, 7>{1, 7, 7, 9, 25, 49, 81});
+    static_assert(ConstexprStringLengths() == 14423222);
+    static_assert(ConstexprLabelsDigits() == 502100304);
+
+    // те же функции во время выполнения идут обычными путями (memmove, std::uninitialized_*)
+    const Vector<uint32_t> runtime_table = BuildCrcTable();
+    assert(std::equal(runtime_table.begin(), runtime_table.end(), CRC_TABLE.begin(), CRC_TABLE.end()));
+    const Vector<int> runtime_squares = BuildOddSquares();
+    assert(std::equal(runtime_squares.begin(), runtime_squares.end(), ODD_SQUARES.begin(), ODD_SQUARES.end()));
+    assert(ConstexprStringLengths() == 14423222);
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (char c : std::string("123456789")) {
+        crc = CRC_TABLE[(crc ^ static_cast<unsigned char>(c)) & 0xFF] ^ (crc >> 8);
+    }
+    assert((crc ^ 0xFFFFFFFFu) == 0xCBF43926u);
+#endif
+}
+
+void Test34() {
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        v.Reserve(3);
+        const int moved_before = Obj::num_moved;
+        v.EmplaceBack(1);
+        v.UncheckedEmplaceBack(2, "b");
+        v.EmplaceBack(v[0]);
+        assert(v.Size() == 3 && v.Capacity() == 3 && Obj::num_moved == moved_before);
+        assert(v[1].name == "b" && v[2].id == 1);
+        // перевыделение при дозаписи копии собственного элемента
+        v.EmplaceBack(v[1]);
+        assert(v.Size() == 4 && v[3].id == 2 && v[0].id == 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<int> v;
+        v.PushBack(-1);
+        {
+            auto appender = v.BatchAppend(16);
+            assert(v.Capacity() >= 17);
+            for (int i = 0; i < 10; ++i) {
+                appender.PushBack(i);
+            }
+            // пока зарезервированного места хватает, размер вектора обновляется только при фиксации
+            assert(appender.Size() == 11 && v.Size() == 1);
+            appender.Commit();
+            assert(v.Size() == 11 && v[10] == 9);
+            for (int i = 10; i < 100; ++i) {
+                appender.PushBack(i);
+            }
+            const int more[] = {7, 8, 9};
+            std::copy(std::begin(more), std::end(more), appender.BackInserter());
+        }
+        assert(v.Size() == 104 && v[0] == -1 && v[50] == 49 && v[103] == 9);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        try {
+            auto appender = v.BatchAppend();
+            for (int i = 0; i < 5; ++i) {
+                appender.EmplaceBack(i);
+            }
+            Obj::default_construction_throw_countdown = 1;
+            appender.EmplaceBack();
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        // добавленные до исключения элементы остаются в векторе
+        assert(v.Size() == 5 && v[4].id == 4);
+        assert(Obj::GetAliveObjectCount() == 5);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test35() {
+    static_assert(BufferRecycler::MAX_CLASS_BYTES == 1024 * 1024);
+    assert(BufferRecycler::ClassIndex(1) == 0 && BufferRecycler::ClassIndex(64) == 0);
+    assert(BufferRecycler::ClassIndex(65) == 1 && BufferRecycler::ClassIndex(128) == 1);
+    assert(BufferRecycler::ClassIndex(129) == 2);
+    assert(BufferRecycler::ClassIndex(BufferRecycler::MAX_CLASS_BYTES) == BufferRecycler::CLASS_COUNT - 1);
+    {
+        BufferRecycler recycler;
+        assert(recycler.ClassCap(64) == BufferRecycler::DEFAULT_CLASS_BUDGET_BYTES / 64);
+        assert(recycler.ClassCap(BufferRecycler::MAX_CLASS_BYTES) == 1);
+        void* const first = recycler.Allocate(100);
+        recycler.Deallocate(first, 100);
+        assert(recycler.Stats().retained_blocks == 1 && recycler.Stats().retained_bytes == 128);
+        // запрос того же класса получает освобождённый блок
+        void* const second = recycler.Allocate(120);
+        assert(second == first);
+        assert(recycler.Stats().hits == 1 && recycler.Stats().misses == 1 && recycler.Stats().HitRate() == 0.5);
+
+        recycler.SetClassCap(100, 1);
+        void* const third = recycler.Allocate(128);
+        recycler.Deallocate(second, 120);
+        recycler.Deallocate(third, 128);
+        assert(recycler.Stats().overflows == 1 && recycler.Stats().retained_blocks == 1);
+
+        void* const large = recycler.Allocate(BufferRecycler::MAX_CLASS_BYTES + 1);
+        recycler.Deallocate(large, BufferRecycler::MAX_CLASS_BYTES + 1);
+        assert(recycler.Stats().bypassed == 1 && recycler.Stats().retained_blocks == 1);
+
+        recycler.Deallocate(recycler.Allocate(4000), 4000);
+        assert(recycler.Stats().retained_bytes == 128 + 4096);
+        assert(recycler.Trim(1000) == 4096 && recycler.Stats().retained_bytes == 128);
+        recycler.ResetStats();
+        assert(recycler.Stats().hits == 0 && recycler.Stats().retained_blocks == 1);
+        assert(recycler.Trim() == 128 && recycler.Stats().retained_blocks == 0);
+    }
+    {
+        BufferRecycler& recycler = *BufferRecycler::ThisThread();
+        recycler.Trim();
+        recycler.ResetStats();
+        const size_t SIZE = 100;
+        for (int round = 0; round < 10; ++round) {
+            RecyclingVector<std::string> v;
+            v.Reserve(SIZE);
+            for (size_t i = 0; i < SIZE; ++i) {
+                v.EmplaceBack(i, 'x');
+            }
+            assert(v.Size() == SIZE && v[SIZE - 1].size() == SIZE - 1);
+        }
+        // каждый круг, кроме первого, получает буфер предыдущего
+        assert(recycler.Stats().misses == 1 && recycler.Stats().hits == 9);
+        assert(recycler.Stats().retained_blocks == 1);
+
+        // вектор, созданный в другом потоке, возвращает буфер в кеш этого потока
+        RecyclingVector<int> from_thread;
+        std::thread([&from_thread] {
+            from_thread.Resize(1000);
+            assert(BufferRecycler::ThisThread()->Stats().misses == 1);
+        }).join();
+        from_thread.ClearAndRelease();
+        assert(recycler.Stats().retained_blocks == 2);
+        assert(recycler.Trim() == BufferRecycler::ClassBytes(BufferRecycler::ClassIndex(SIZE * sizeof(std::string)))
+                                      + BufferRecycler::ClassBytes(BufferRecycler::ClassIndex(1000 * sizeof(int))));
     }
 }
 
@@ -648,7 +2873,35 @@ int main() {
         Test4();
         Test5();
         Test6();
-        Benchmark();
+        Test7();
+        Test8();
+        Test9();
+        Test10();
+        Test11();
+        Test12();
+        Test13();
+        Test14();
+        Test15();
+        Test16();
+        Test17();
+        Test18();
+        Test19();
+        Test20();
+        Test21();
+        Test22();
+        Test23();
+        Test24();
+        Test25();
+        Test26();
+        Test27();
+        Test28();
+        Test29();
+        Test30();
+        Test31();
+        Test32();
+        Test33();
+        Test34();
+        Test35();
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
     }
@@ -0,0 +1,364 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Способ доступа к элементам, сообщаемый ядру через madvise
+enum class AccessPattern {
+    Normal,
+    Sequential,
+    Random,
+    // элементы скоро понадобятся: страницы подгружаются заранее
+    WillNeed,
+    // элементы долго не понадобятся: страницы можно вытеснить
+    DontNeed,
+};
+
+// Вектор тривиально копируемых элементов, хранящихся в отображённом в память файле (mmap).
+// Данные переживают перезапуск процесса и могут превышать объём оперативной памяти:
+// при повторном открытии файл просто отображается заново, без десериализации.
+// Буфер растёт увеличением файла (ftruncate) и переотображением (mremap), без копирования элементов.
+// Итераторы и индексация те же, что у Vector; как и у Vector, рост инвалидирует итераторы.
+// Размер хранится в заголовке файла и обновляется при каждом изменении, поэтому Flush нужен
+// только для гарантии записи на диск, а не для согласованности файла
+template <typename T, typename GrowthPolicy = DoublingGrowth>
+class MappedVector {
+    static_assert(std::is_trivially_copyable_v<T>, "MappedVector stores elements as raw bytes");
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    MappedVector() = default;
+
+    // Открывает файл path, создавая его при отсутствии
+    explicit MappedVector(const std::string& path) {
+        Open(path);
+    }
+
+    MappedVector(const MappedVector&) = delete;
+    MappedVector& operator=(const MappedVector&) = delete;
+
+    MappedVector(MappedVector&& other) noexcept
+        : fd_(std::exchange(other.fd_, -1))
+        , mapping_(std::exchange(other.mapping_, nullptr))
+        , capacity_(std::exchange(other.capacity_, 0)) {
+    }
+
+    MappedVector& operator=(MappedVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Close();
+            fd_ = std::exchange(rhs.fd_, -1);
+            mapping_ = std::exchange(rhs.mapping_, nullptr);
+            capacity_ = std::exchange(rhs.capacity_, 0);
+        }
+        return *this;
+    }
+
+    ~MappedVector() {
+        Close();
+    }
+
+    // Открывает файл path, создавая его при отсутствии. Ранее открытый файл закрывается.
+    // Если файл создан для элементов другого размера или повреждён, выбрасывает std::runtime_error
+    void Open(const std::string& path) {
+        Close();
+        const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            ThrowSystemError("open");
+        }
+        try {
+            struct stat st {};
+            if (::fstat(fd, &st) != 0) {
+                ThrowSystemError("fstat");
+            }
+            size_t file_size = static_cast<size_t>(st.st_size);
+            const bool created = file_size == 0;
+            if (created) {
+                Truncate(fd, HEADER_SIZE);
+                file_size = HEADER_SIZE;
+            } else if (file_size < HEADER_SIZE || (file_size - HEADER_SIZE) % sizeof(T) != 0) {
+                throw std::runtime_error("MappedVector: file size does not match element type");
+            }
+            void* mapping = Map(fd, file_size);
+            auto* header = static_cast<Header*>(mapping);
+            const size_t capacity = (file_size - HEADER_SIZE) / sizeof(T);
+            if (created) {
+                *header = Header{};
+            } else if (header->magic != MAGIC || header->element_size != sizeof(T)
+                       || header->element_align != alignof(T) || header->size > capacity) {
+                ::munmap(mapping, file_size);
+                throw std::runtime_error("MappedVector: file header does not match element type");
+            }
+            fd_ = fd;
+            mapping_ = mapping;
+            capacity_ = capacity;
+        }
+        catch (...) {
+            ::close(fd);
+            throw;
+        }
+    }
+
+    // Синхронно записывает изменения на диск
+    void Flush() {
+        assert(IsOpen());
+        if (::msync(mapping_, MappingSize(capacity_), MS_SYNC) != 0) {
+            ThrowSystemError("msync");
+        }
+    }
+
+    // Закрывает файл. Изменённые страницы будут записаны ядром; для немедленной записи вызовите Flush
+    void Close() noexcept {
+        if (mapping_ != nullptr) {
+            ::munmap(mapping_, MappingSize(capacity_));
+            mapping_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        capacity_ = 0;
+    }
+
+    bool IsOpen() const noexcept {
+        return mapping_ != nullptr;
+    }
+
+    // Подсказывает ядру, как будут читаться элементы, чтобы оно выбрало упреждающее чтение
+    void Advise(AccessPattern pattern) {
+        assert(IsOpen());
+        if (::madvise(mapping_, MappingSize(capacity_), ToAdvice(pattern)) != 0) {
+            ThrowSystemError("madvise");
+        }
+    }
+
+    iterator begin() noexcept {
+        return Data();
+    }
+    iterator end() noexcept {
+        return Data() + Size();
+    }
+    const_iterator begin() const noexcept {
+        return Data();
+    }
+    const_iterator end() const noexcept {
+        return Data() + Size();
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<MappedVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        VECTOR_CHECK(index < Size(), "index %zu out of range for size %zu", index, Size());
+        return Data()[index];
+    }
+
+    size_t Size() const noexcept {
+        return mapping_ != nullptr ? GetHeader()->size : 0;
+    }
+
+    size_t Capacity() const noexcept {
+        return capacity_;
+    }
+
+    // Максимальное число элементов, ограниченное размером файла
+    size_t MaxSize() const noexcept {
+        return (static_cast<size_t>(std::numeric_limits<off_t>::max()) - HEADER_SIZE) / sizeof(T);
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= capacity_) {
+            return;
+        }
+        if (new_capacity > MaxSize()) {
+            throw std::length_error("MappedVector capacity overflow");
+        }
+        Remap(new_capacity);
+    }
+
+    // Уменьшает файл до размера вектора
+    void ShrinkToFit() {
+        if (capacity_ != Size()) {
+            Remap(Size());
+        }
+    }
+
+    void Clear() noexcept {
+        SetSize(0);
+    }
+
+    // Новые элементы инициализируются значением по умолчанию
+    void Resize(size_t new_size) {
+        const size_t size = Size();
+        if (new_size > size) {
+            ReserveForGrowth(new_size);
+            std::uninitialized_value_construct_n(Data() + size, new_size - size);
+        }
+        SetSize(new_size);
+    }
+
+    // args могут ссылаться на элементы этого же файла, а рост его переотображает, поэтому элемент
+    // создаётся до роста и копируется на место
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        const T value(std::forward<Args>(args)...);
+        const size_t size = Size();
+        ReserveForGrowth(size + 1);
+        T* const result = new (Data() + size) T(value);
+        SetSize(size + 1);
+        return *result;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PopBack() noexcept {
+        VECTOR_CHECK(Size() > 0, "PopBack on empty vector");
+        SetSize(Size() - 1);
+    }
+
+    // Добавляет в конец элементы диапазона [first, last), перевыделяя буфер не более одного раза
+    template <typename ForwardIt, typename = detail::RequireInputIterator<ForwardIt>>
+    void Append(ForwardIt first, ForwardIt last) {
+        static_assert(detail::is_forward_iterator_v<ForwardIt>);
+        const size_t size = Size();
+        const size_t count = static_cast<size_t>(std::distance(first, last));
+        if (count > MaxSize() - size) {
+            throw std::length_error("MappedVector capacity overflow");
+        }
+        ReserveForGrowth(size + count);
+        std::uninitialized_copy_n(first, count, Data() + size);
+        SetSize(size + count);
+    }
+
+private:
+    // Заголовок в начале файла. Элементы начинаются со смещения HEADER_SIZE
+    struct Header {
+        uint64_t magic = MAGIC;
+        uint32_t element_size = sizeof(T);
+        uint32_t element_align = alignof(T);
+        uint64_t size = 0;
+    };
+
+    static constexpr uint64_t MAGIC = 0x31564d45'56444441;  // "ADDVEMV1" в порядке байтов little-endian
+    static constexpr size_t HEADER_SIZE = 64;
+    static_assert(sizeof(Header) <= HEADER_SIZE && alignof(T) <= HEADER_SIZE,
+                  "Element alignment is limited by the file header size");
+
+    static size_t MappingSize(size_t capacity) noexcept {
+        return HEADER_SIZE + capacity * sizeof(T);
+    }
+
+    [[noreturn]] static void ThrowSystemError(const char* what) {
+        throw std::system_error(errno, std::generic_category(), std::string("MappedVector: ") + what);
+    }
+
+    static void Truncate(int fd, size_t file_size) {
+        if (::ftruncate(fd, static_cast<off_t>(file_size)) != 0) {
+            ThrowSystemError("ftruncate");
+        }
+    }
+
+    static void* Map(int fd, size_t length) {
+        void* mapping = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED) {
+            ThrowSystemError("mmap");
+        }
+        return mapping;
+    }
+
+    static int ToAdvice(AccessPattern pattern) noexcept {
+        switch (pattern) {
+            case AccessPattern::Sequential:
+                return MADV_SEQUENTIAL;
+            case AccessPattern::Random:
+                return MADV_RANDOM;
+            case AccessPattern::WillNeed:
+                return MADV_WILLNEED;
+            case AccessPattern::DontNeed:
+                return MADV_DONTNEED;
+            case AccessPattern::Normal:
+                break;
+        }
+        return MADV_NORMAL;
+    }
+
+    Header* GetHeader() const noexcept {
+        return static_cast<Header*>(mapping_);
+    }
+
+    T* Data() const noexcept {
+        return mapping_ != nullptr ? reinterpret_cast<T*>(static_cast<char*>(mapping_) + HEADER_SIZE) : nullptr;
+    }
+
+    void SetSize(size_t size) noexcept {
+        assert(size <= capacity_);
+        if (mapping_ != nullptr) {
+            GetHeader()->size = size;
+        }
+    }
+
+    void ReserveForGrowth(size_t required) {
+        assert(IsOpen());
+        if (required > capacity_) {
+            Reserve(GrowthPolicy::NextCapacity(capacity_, required, sizeof(T), MaxSize()));
+        }
+    }
+
+    // Изменяет размер файла и отображения. Содержимое файла не копируется: при росте ядро
+    // расширяет отображение на месте или переносит его таблицы страниц
+    void Remap(size_t new_capacity) {
+        assert(IsOpen() && new_capacity >= Size());
+        const size_t old_length = MappingSize(capacity_);
+        const size_t new_length = MappingSize(new_capacity);
+        if (new_length > old_length) {
+            Truncate(fd_, new_length);
+        }
+#ifdef __linux__
+        void* mapping = ::mremap(mapping_, old_length, new_length, MREMAP_MAYMOVE);
+        if (mapping == MAP_FAILED) {
+            ThrowSystemError("mremap");
+        }
+#else
+        void* mapping = Map(fd_, new_length);
+        ::munmap(mapping_, old_length);
+#endif
+        mapping_ = mapping;
+        capacity_ = new_capacity;
+        if (new_length < old_length) {
+            // отображение уже уменьшено; если ftruncate не удастся, в файле останутся лишь неиспользуемые
+            // ячейки, которые при следующем открытии войдут во вместимость
+            Truncate(fd_, new_length);
+        }
+    }
+
+    int fd_ = -1;
+    void* mapping_ = nullptr;
+    size_t capacity_ = 0;
+};
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <utility>
+
+// Пул блоков фиксированного размера. Блоки нарезаются из крупных кусков и после освобождения
+// попадают в список свободных, поэтому повторное выделение не обращается к системному аллокатору.
+// Не потокобезопасен: пул предполагается заводить на поток или на узел NUMA
+class FixedPool {
+public:
+    static constexpr size_t DEFAULT_BLOCKS_PER_CHUNK = 64;
+
+    explicit FixedPool(size_t block_size, size_t blocks_per_chunk = DEFAULT_BLOCKS_PER_CHUNK)
+        : block_size_(RoundUp(std::max(block_size, sizeof(FreeBlock))))
+        , blocks_per_chunk_(blocks_per_chunk) {
+        assert(blocks_per_chunk_ != 0);
+    }
+
+    FixedPool(const FixedPool&) = delete;
+    FixedPool& operator=(const FixedPool&) = delete;
+
+    ~FixedPool() {
+        while (chunks_ != nullptr) {
+            Chunk* next = chunks_->next;
+            operator delete(chunks_);
+            chunks_ = next;
+        }
+    }
+
+    void* Allocate() {
+        if (free_ == nullptr) {
+            AddChunk();
+        }
+        FreeBlock* block = std::exchange(free_, free_->next);
+        ++blocks_in_use_;
+        return block;
+    }
+
+    void Deallocate(void* ptr) noexcept {
+        assert(blocks_in_use_ > 0);
+        free_ = new (ptr) FreeBlock{free_};
+        --blocks_in_use_;
+    }
+
+    size_t BlockSize() const noexcept {
+        return block_size_;
+    }
+
+    size_t BlocksInUse() const noexcept {
+        return blocks_in_use_;
+    }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct alignas(std::max_align_t) Chunk {
+        Chunk* next;
+    };
+
+    static size_t RoundUp(size_t size) noexcept {
+        constexpr size_t alignment = alignof(std::max_align_t);
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    void AddChunk() {
+        if (block_size_ > (std::numeric_limits<size_t>::max() - sizeof(Chunk)) / blocks_per_chunk_) {
+            throw std::bad_alloc();
+        }
+        auto* chunk = static_cast<Chunk*>(operator new(sizeof(Chunk) + block_size_ * blocks_per_chunk_));
+        chunk->next = chunks_;
+        chunks_ = chunk;
+        char* blocks = reinterpret_cast<char*>(chunk + 1);
+        for (size_t i = blocks_per_chunk_; i > 0; --i) {
+            free_ = new (blocks + (i - 1) * block_size_) FreeBlock{free_};
+        }
+    }
+
+    size_t block_size_;
+    size_t blocks_per_chunk_;
+    Chunk* chunks_ = nullptr;
+    FreeBlock* free_ = nullptr;
+    size_t blocks_in_use_ = 0;
+};
+
+// Аллокатор поверх FixedPool. Запросы, умещающиеся в блок пула, обслуживаются пулом,
+// более крупные (и требующие особого выравнивания) передаются глобальному operator new.
+// Как и ArenaAllocator, не распространяется между контейнерами
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    explicit PoolAllocator(FixedPool& pool) noexcept
+        : pool_(&pool) {
+    }
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& other) noexcept
+        : pool_(&other.GetPool()) {
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        if (FitsPool(n)) {
+            return static_cast<T*>(pool_->Allocate());
+        }
+        return static_cast<T*>(operator new(n * sizeof(T), std::align_val_t{alignof(T)}));
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        if (FitsPool(n)) {
+            pool_->Deallocate(ptr);
+        } else {
+            operator delete(ptr, n * sizeof(T), std::align_val_t{alignof(T)});
+        }
+    }
+
+    FixedPool& GetPool() const noexcept {
+        return *pool_;
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>& other) const noexcept {
+        return pool_ == &other.GetPool();
+    }
+
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    bool FitsPool(size_t n) const noexcept {
+        return alignof(T) <= alignof(std::max_align_t) && n * sizeof(T) <= pool_->BlockSize();
+    }
+
+    FixedPool* pool_;
+};
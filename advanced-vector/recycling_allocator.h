@@ -0,0 +1,271 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Статистика BufferRecycler
+struct RecyclerStats {
+    // выделения в пределах классов: обслуженные из кеша и ушедшие в operator new
+    size_t hits = 0;
+    size_t misses = 0;
+    // выделения крупнее BufferRecycler::MAX_CLASS_BYTES, минующие кеш
+    size_t bypassed = 0;
+    // освобождённые блоки, не поместившиеся в заполненный класс и возвращённые operator delete
+    size_t overflows = 0;
+    // блоки, лежащие в кеше, и занимаемая ими память
+    size_t retained_blocks = 0;
+    size_t retained_bytes = 0;
+
+    // Доля выделений в пределах классов, обслуженных из кеша
+    double HitRate() const noexcept {
+        const size_t total = hits + misses;
+        return total == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(total);
+    }
+};
+
+namespace detail {
+
+// Выставляется, когда кеш потока разрушен. Переменная тривиально разрушаема, поэтому её можно читать
+// до самого конца потока, в том числе из деструкторов, выполняющихся после разрушения кеша
+inline thread_local bool buffer_recycler_destroyed = false;
+
+}  // namespace detail
+
+// Кеш освобождённых буферов. Блоки распределены по классам размеров — степеням двойки от MIN_CLASS_BYTES
+// до MAX_CLASS_BYTES; запрос округляется вверх до класса, и освобождённый блок попадает в список свободных
+// блоков своего класса, откуда его забирает следующее выделение того же класса без обращения к operator new.
+// Каждый класс удерживает не больше своего предела блоков (по умолчанию на DEFAULT_CLASS_BUDGET_BYTES байт,
+// но хотя бы один блок), лишние возвращаются operator delete. Не потокобезопасен: RecyclingAllocator
+// использует отдельный кеш на каждый поток (ThisThread), поэтому потоки не конкурируют за общую кучу.
+// Все блоки получены из operator new, так что блок можно освободить в любом кеше, а не только в том,
+// которым он был выдан
+class BufferRecycler {
+public:
+    static constexpr size_t MIN_CLASS_SHIFT = 6;
+    static constexpr size_t MIN_CLASS_BYTES = size_t{1} << MIN_CLASS_SHIFT;
+    static constexpr size_t CLASS_COUNT = 15;
+    static constexpr size_t MAX_CLASS_BYTES = MIN_CLASS_BYTES << (CLASS_COUNT - 1);
+    static constexpr size_t DEFAULT_CLASS_BUDGET_BYTES = 256 * 1024;
+
+    BufferRecycler() noexcept {
+        for (size_t index = 0; index < CLASS_COUNT; ++index) {
+            classes_[index].cap = std::max<size_t>(1, DEFAULT_CLASS_BUDGET_BYTES / ClassBytes(index));
+        }
+    }
+
+    BufferRecycler(const BufferRecycler&) = delete;
+    BufferRecycler& operator=(const BufferRecycler&) = delete;
+
+    ~BufferRecycler() {
+        Trim();
+    }
+
+    // Кеш текущего потока. Возвращает nullptr, если поток завершается и его кеш уже разрушен
+    static BufferRecycler* ThisThread() noexcept {
+        struct ThreadCache {
+            ~ThreadCache() {
+                detail::buffer_recycler_destroyed = true;
+            }
+
+            BufferRecycler recycler;
+        };
+
+        if (detail::buffer_recycler_destroyed) {
+            return nullptr;
+        }
+        thread_local ThreadCache cache;
+        return &cache.recycler;
+    }
+
+    // Выделяет блок не меньше bytes байт с выравниванием operator new
+    void* Allocate(size_t bytes) {
+        if (bytes > MAX_CLASS_BYTES) {
+            ++stats_.bypassed;
+            return operator new(bytes);
+        }
+        const size_t index = ClassIndex(bytes);
+        SizeClass& size_class = classes_[index];
+        if (size_class.head == nullptr) {
+            ++stats_.misses;
+            return operator new(ClassBytes(index));
+        }
+        ++stats_.hits;
+        --size_class.count;
+        --stats_.retained_blocks;
+        stats_.retained_bytes -= ClassBytes(index);
+        return std::exchange(size_class.head, size_class.head->next);
+    }
+
+    // Освобождает блок, выделенный Allocate(bytes) этого или другого BufferRecycler
+    void Deallocate(void* ptr, size_t bytes) noexcept {
+        if (bytes > MAX_CLASS_BYTES) {
+            operator delete(ptr);
+            return;
+        }
+        const size_t index = ClassIndex(bytes);
+        SizeClass& size_class = classes_[index];
+        if (size_class.count >= size_class.cap) {
+            ++stats_.overflows;
+            operator delete(ptr);
+            return;
+        }
+        size_class.head = new (ptr) FreeBlock{size_class.head};
+        ++size_class.count;
+        ++stats_.retained_blocks;
+        stats_.retained_bytes += ClassBytes(index);
+    }
+
+    // Предел числа блоков класса, в который попадает запрос bytes байт. Блоки сверх нового предела освобождаются
+    void SetClassCap(size_t bytes, size_t cap) noexcept {
+        assert(bytes <= MAX_CLASS_BYTES);
+        const size_t index = ClassIndex(bytes);
+        classes_[index].cap = cap;
+        while (classes_[index].count > cap) {
+            ReleaseBlock(index);
+        }
+    }
+
+    size_t ClassCap(size_t bytes) const noexcept {
+        assert(bytes <= MAX_CLASS_BYTES);
+        return classes_[ClassIndex(bytes)].cap;
+    }
+
+    // Возвращает блоки operator delete, начиная с крупных классов, пока в кеше больше max_retained_bytes байт.
+    // Возвращает объём освобождённой памяти
+    size_t Trim(size_t max_retained_bytes = 0) noexcept {
+        size_t released = 0;
+        for (size_t index = CLASS_COUNT; index-- > 0;) {
+            while (classes_[index].head != nullptr && stats_.retained_bytes > max_retained_bytes) {
+                ReleaseBlock(index);
+                released += ClassBytes(index);
+            }
+        }
+        return released;
+    }
+
+    const RecyclerStats& Stats() const noexcept {
+        return stats_;
+    }
+
+    // Обнуляет счётчики выделений; сведения о блоках в кеше сохраняются
+    void ResetStats() noexcept {
+        RecyclerStats stats;
+        stats.retained_blocks = stats_.retained_blocks;
+        stats.retained_bytes = stats_.retained_bytes;
+        stats_ = stats;
+    }
+
+    // Размер блоков класса index
+    static constexpr size_t ClassBytes(size_t index) noexcept {
+        return MIN_CLASS_BYTES << index;
+    }
+
+    // Наименьший класс, блок которого вмещает bytes байт (bytes <= MAX_CLASS_BYTES)
+    static size_t ClassIndex(size_t bytes) noexcept {
+        if (bytes <= MIN_CLASS_BYTES) {
+            return 0;
+        }
+#if defined(__GNUC__)
+        // число значащих битов bytes - 1 равно округлённому вверх log2(bytes)
+        const int bits = std::numeric_limits<unsigned long long>::digits - __builtin_clzll(bytes - 1);
+        return static_cast<size_t>(bits) - MIN_CLASS_SHIFT;
+#else
+        size_t index = 0;
+        while (ClassBytes(index) < bytes) {
+            ++index;
+        }
+        return index;
+#endif
+    }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct SizeClass {
+        FreeBlock* head = nullptr;
+        size_t count = 0;
+        size_t cap = 0;
+    };
+
+    void ReleaseBlock(size_t index) noexcept {
+        SizeClass& size_class = classes_[index];
+        FreeBlock* const block = std::exchange(size_class.head, size_class.head->next);
+        --size_class.count;
+        --stats_.retained_blocks;
+        stats_.retained_bytes -= ClassBytes(index);
+        operator delete(block);
+    }
+
+    std::array<SizeClass, CLASS_COUNT> classes_;
+    RecyclerStats stats_;
+};
+
+// Аллокатор, берущий буферы из кеша BufferRecycler текущего потока. Подходит для множества короткоживущих
+// векторов похожих размеров: после разогрева выделение и освобождение — операции со списком свободных
+// блоков потока. Блок, выделенный в одном потоке, можно освободить в другом: он попадёт в кеш
+// освобождающего потока. Типы с выравниванием больше, чем у operator new, выделяются мимо кеша
+template <typename T>
+class RecyclingAllocator {
+    static constexpr bool RECYCLED = alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    RecyclingAllocator() = default;
+
+    template <typename U>
+    RecyclingAllocator(const RecyclingAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        const size_t bytes = n * sizeof(T);
+        if constexpr (RECYCLED) {
+            BufferRecycler* const recycler = BufferRecycler::ThisThread();
+            return static_cast<T*>(recycler != nullptr ? recycler->Allocate(bytes) : operator new(bytes));
+        } else {
+            return static_cast<T*>(operator new(bytes, std::align_val_t{alignof(T)}));
+        }
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+        if constexpr (RECYCLED) {
+            BufferRecycler* const recycler = BufferRecycler::ThisThread();
+            if (recycler != nullptr) {
+                recycler->Deallocate(ptr, bytes);
+            } else {
+                operator delete(ptr);
+            }
+        } else {
+            operator delete(ptr, bytes, std::align_val_t{alignof(T)});
+        }
+    }
+
+    template <typename U>
+    bool operator==(const RecyclingAllocator<U>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const RecyclingAllocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+// Вектор, буферы которого переиспользуются через кеш потока
+template <typename T, typename GrowthPolicy = DoublingGrowth>
+using RecyclingVector = Vector<T, RecyclingAllocator<T>, GrowthPolicy>;
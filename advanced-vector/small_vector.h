@@ -0,0 +1,466 @@
+#pragma once
+
+#include "vector.h"
+
+// Вектор, хранящий до N элементов прямо в объекте и переходящий в динамическую память
+// (RawMemory) только при переполнении. Интерфейс и гарантии безопасности исключений те же,
+// что у Vector, операции над элементами выполняются теми же функциями из detail.
+// В отличие от Vector, перемещение и обмен векторов во встроенном буфере перемещают элементы.
+// Политика с автоматическим уменьшением (HysteresisShrink) уменьшает динамический буфер так же, как
+// у Vector, а если элементы помещаются во встроенный буфер, переносит их туда
+template <typename T, size_t N, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth>
+class SmallVector {
+    static_assert(N > 0, "Use Vector if no inline storage is needed");
+
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
+    SmallVector() = default;
+
+    explicit SmallVector(const Allocator& alloc) noexcept
+        : heap_(alloc) {
+    }
+
+    explicit SmallVector(size_t size, const Allocator& alloc = Allocator())
+        : heap_(alloc)
+    {
+        Reserve(size);
+        std::uninitialized_value_construct_n(Data(), size);
+        size_ = size;
+    }
+
+    SmallVector(const SmallVector& other)
+        : heap_(AllocTraits::select_on_container_copy_construction(other.GetAllocator()))
+    {
+        Reserve(other.size_);
+        std::uninitialized_copy_n(other.Data(), other.size_, Data());
+        size_ = other.size_;
+    }
+
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : heap_(other.GetAllocator())
+    {
+        if (other.IsInline()) {
+            detail::UninitializedRelocateN(other.Data(), other.size_, Data());
+            size_ = std::exchange(other.size_, 0);
+        } else {
+            heap_.Swap(other.heap_);
+            size_ = std::exchange(other.size_, 0);
+        }
+    }
+
+    ~SmallVector() {
+        detail::CountRelease<T>(heap_.Capacity(), size_);
+        std::destroy_n(Data(), size_);
+    }
+
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    iterator begin() noexcept {
+        return Data();
+    }
+    iterator end() noexcept {
+        return Data() + size_;
+    }
+    const_iterator begin() const noexcept {
+        return Data();
+    }
+    const_iterator end() const noexcept {
+        return Data() + size_;
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    SmallVector& operator=(const SmallVector& rhs) {
+        if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                if (GetAllocator() != rhs.GetAllocator()) {
+                    // текущий буфер нельзя переиспользовать: он принадлежит старому аллокатору
+                    SmallVector rhs_copy(rhs.GetAllocator());
+                    rhs_copy.Assign(rhs.begin(), rhs.end());
+                    TakeStorage(rhs_copy);
+                    return *this;
+                }
+            }
+            if (rhs.size_ > Capacity()) {
+                ReplaceWithCopy(rhs.Data(), rhs.size_);
+            } else {
+                detail::AssignInPlace(Data(), size_, rhs.Data(), rhs.size_);
+            }
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& rhs) {
+        if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+                // аллокатор переходит вместе с элементами
+                TakeStorage(rhs);
+            } else if (!rhs.IsInline() && GetAllocator() == rhs.GetAllocator()) {
+                // забираем динамический буфер rhs целиком, а свой освобождаем
+                TakeStorage(rhs);
+            } else if (rhs.size_ > Capacity()) {
+                ReplaceWithCopy(std::make_move_iterator(rhs.begin()), rhs.size_);
+                rhs.Clear();
+            } else {
+                detail::AssignInPlace(Data(), size_, std::make_move_iterator(rhs.begin()), rhs.size_);
+                rhs.Clear();
+            }
+        }
+        return *this;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SmallVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        VECTOR_CHECK(index < size_, "index %zu out of range for size %zu", index, size_);
+        return Data()[index];
+    }
+
+    void Swap(SmallVector& other) {
+        if (!IsInline() && !other.IsInline()) {
+            heap_.Swap(other.heap_);
+            std::swap(size_, other.size_);
+        } else {
+            SmallVector tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return IsInline() ? N : heap_.Capacity();
+    }
+
+    size_t MaxSize() const noexcept {
+        return std::min<size_t>(AllocTraits::max_size(GetAllocator()),
+                                std::numeric_limits<std::ptrdiff_t>::max() / sizeof(T));
+    }
+
+    const Allocator& GetAllocator() const noexcept {
+        return heap_.GetAllocator();
+    }
+
+    // Находятся ли элементы во встроенном буфере
+    bool IsInline() const noexcept {
+        return heap_.Capacity() == 0;
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+        if (new_capacity > MaxSize()) {
+            throw std::length_error("SmallVector capacity overflow");
+        }
+
+        RawMemory<T, Allocator> new_data(new_capacity, GetAllocator());
+        detail::UninitializedRelocateN(Data(), size_, new_data.GetAddress());
+        heap_.Swap(new_data);
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size <= size_) {
+            Truncate(new_size);
+        } else {
+            ReserveForGrowth(new_size);
+            std::uninitialized_value_construct_n(Data() + size_, new_size - size_);
+            size_ = new_size;
+        }
+    }
+
+    void Resize(size_t new_size, const T& value) {
+        if (new_size <= size_) {
+            Truncate(new_size);
+        } else {
+            Insert(end(), new_size - size_, value);
+        }
+    }
+
+    void ResizeDefaultInit(size_t new_size) {
+        if (new_size <= size_) {
+            Truncate(new_size);
+        } else {
+            ReserveForGrowth(new_size);
+            std::uninitialized_default_construct_n(Data() + size_, new_size - size_);
+            size_ = new_size;
+        }
+    }
+
+    // Уменьшает вместимость до размера; если элементы умещаются во встроенный буфер,
+    // переносит их туда и освобождает динамическую память
+    void ShrinkToFit() {
+        if (IsInline() || heap_.Capacity() == size_) {
+            return;
+        }
+        ShrinkTo(size_);
+    }
+
+    void Clear() noexcept {
+        std::destroy_n(Data(), size_);
+        size_ = 0;
+    }
+
+    // Удаляет все элементы и освобождает динамическую память
+    void ClearAndRelease() noexcept {
+        Clear();
+        RawMemory<T, Allocator>(GetAllocator()).Swap(heap_);
+    }
+
+    void PopBack() {
+        if (size_ > 0) {
+            --size_;
+            std::destroy_at(Data() + size_);
+            MaybeShrink();
+        }
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        return *Emplace(end(), std::forward<Args>(args)...);
+    }
+
+    template <typename Type>
+    void PushBack(Type&& value) {
+        EmplaceBack(std::forward<Type>(value));
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args) {
+        VECTOR_CHECK(pos >= begin() && pos <= end(), "position %td outside [0, %zu]", pos - cbegin(), size_);
+        const size_t pos_num = pos - begin();
+        if (size_ != Capacity()) {
+            return detail::EmplaceInPlace(Data(), size_, pos_num, std::forward<Args>(args)...);
+        }
+
+        RawMemory<T, Allocator> new_data(GrowthCapacity(size_ + 1), GetAllocator());
+        T* value = new (new_data + pos_num) T(std::forward<Args>(args)...);
+        detail::UninitializedRelocateWithGap(Data(), size_, pos_num, 1, new_data.GetAddress());
+        heap_.Swap(new_data);
+        ++size_;
+        return value;
+    }
+
+    iterator Erase(const_iterator pos) {
+        VECTOR_CHECK(pos >= begin() && pos < end(), "position %td outside [0, %zu)", pos - cbegin(), size_);
+        return Erase(pos, pos + 1);
+    }
+
+    iterator Erase(const_iterator first, const_iterator last) {
+        VECTOR_CHECK(first >= begin() && first <= last && last <= end(), "range [%td, %td) outside [0, %zu]",
+                     first - cbegin(), last - cbegin(), size_);
+        const size_t pos_num = first - begin();
+        if (first != last) {
+            detail::EraseInPlace(Data(), size_, pos_num, last - first);
+            MaybeShrink();
+        }
+        return begin() + pos_num;
+    }
+
+    iterator UnorderedErase(const_iterator pos) {
+        VECTOR_CHECK(pos >= begin() && pos < end(), "position %td outside [0, %zu)", pos - cbegin(), size_);
+        const size_t pos_num = pos - begin();
+        detail::UnorderedEraseInPlace(Data(), size_, pos_num);
+        MaybeShrink();
+        return begin() + pos_num;
+    }
+
+    iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+        VECTOR_CHECK(pos >= begin() && pos <= end(), "position %td outside [0, %zu]", pos - cbegin(), size_);
+        const size_t pos_num = pos - begin();
+        if constexpr (detail::is_forward_iterator_v<InputIt>) {
+            return InsertN(pos_num, first, static_cast<size_t>(std::distance(first, last)));
+        } else {
+            const size_t old_size = size_;
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+            std::rotate(begin() + pos_num, begin() + old_size, end());
+            return begin() + pos_num;
+        }
+    }
+
+    iterator Insert(const_iterator pos, size_t count, const T& value) {
+        VECTOR_CHECK(pos >= begin() && pos <= end(), "position %td outside [0, %zu]", pos - cbegin(), size_);
+        const size_t pos_num = pos - begin();
+        if (count <= Capacity() - size_) {
+            const T value_copy(value);
+            return InsertN(pos_num, detail::RepeatIterator<T>(value_copy, 0), count);
+        }
+        return InsertN(pos_num, detail::RepeatIterator<T>(value, 0), count);
+    }
+
+    iterator Insert(const_iterator pos, std::initializer_list<T> values) {
+        return Insert(pos, values.begin(), values.end());
+    }
+
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    void Append(InputIt first, InputIt last) {
+        Insert(end(), first, last);
+    }
+
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    void Assign(InputIt first, InputIt last) {
+        if constexpr (detail::is_forward_iterator_v<InputIt>) {
+            const size_t count = static_cast<size_t>(std::distance(first, last));
+            if (count > Capacity()) {
+                ReplaceWithCopy(first, count);
+            } else {
+                detail::AssignInPlace(Data(), size_, first, count);
+            }
+        } else {
+            detail::AssignFromInput(Data(), size_, first, last, [this](const auto& value) {
+                EmplaceBack(value);
+            });
+        }
+    }
+
+private:
+    T* Data() noexcept {
+        return IsInline() ? reinterpret_cast<T*>(inline_buffer_) : heap_.GetAddress();
+    }
+
+    const T* Data() const noexcept {
+        return const_cast<SmallVector&>(*this).Data();
+    }
+
+    size_t GrowthCapacity(size_t required) const {
+        return GrowthPolicy::NextCapacity(Capacity(), required, sizeof(T), MaxSize());
+    }
+
+    void ReserveForGrowth(size_t required) {
+        if (required > Capacity()) {
+            Reserve(GrowthCapacity(required));
+        }
+    }
+
+    // Удаляет элементы начиная с new_size (new_size <= Size())
+    void Truncate(size_t new_size) noexcept {
+        std::destroy_n(Data() + new_size, size_ - new_size);
+        size_ = new_size;
+        MaybeShrink();
+    }
+
+    // Переносит элементы динамического буфера в буфер вместимостью new_capacity (Size() <= new_capacity),
+    // а если new_capacity не больше N — во встроенный буфер, освобождая динамическую память
+    void ShrinkTo(size_t new_capacity) {
+        if (new_capacity > N) {
+            RawMemory<T, Allocator> new_data(new_capacity, GetAllocator());
+            detail::UninitializedRelocateN(Data(), size_, new_data.GetAddress());
+            heap_.Swap(new_data);
+            return;
+        }
+        RawMemory<T, Allocator> old_data(GetAllocator());
+        old_data.Swap(heap_);
+        try {
+            detail::UninitializedRelocateN(old_data.GetAddress(), size_, Data());
+        }
+        catch (...) {
+            old_data.Swap(heap_);
+            throw;
+        }
+    }
+
+    // Уменьшает вместимость, если этого требует политика роста. Как и у Vector, уменьшение необязательно,
+    // поэтому неудачное перевыделение игнорируется
+    void MaybeShrink() noexcept {
+        if constexpr (GrowthPolicy::AUTO_SHRINK) {
+            if (IsInline()) {
+                return;
+            }
+            const size_t new_capacity = GrowthPolicy::ShrinkCapacity(size_, Capacity());
+            if (new_capacity < Capacity()) {
+                try {
+                    ShrinkTo(new_capacity);
+                }
+                catch (...) {
+                }
+            }
+        }
+    }
+
+    // Заменяет элементы и аллокатор элементами и аллокатором other, оставляя other пустым.
+    // Динамический буфер other забирается целиком, элементы его встроенного буфера переносятся.
+    // Собственный буфер освобождается своим аллокатором
+    void TakeStorage(SmallVector& other) {
+        Clear();
+        heap_ = std::move(other.heap_);
+        if (IsInline()) {
+            detail::UninitializedRelocateN(other.Data(), other.size_, Data());
+        }
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    // Заменяет элементы на count элементов, начиная с first, в новом динамическом буфере
+    // (count > Capacity()). При исключении вектор не меняется
+    template <typename ForwardIt>
+    void ReplaceWithCopy(ForwardIt first, size_t count) {
+        if (count > MaxSize()) {
+            throw std::length_error("SmallVector capacity overflow");
+        }
+        RawMemory<T, Allocator> new_data(count, GetAllocator());
+        std::uninitialized_copy_n(first, count, new_data.GetAddress());
+        std::destroy_n(Data(), size_);
+        heap_.Swap(new_data);
+        size_ = count;
+    }
+
+    template <typename ForwardIt>
+    iterator InsertN(size_t pos_num, ForwardIt first, size_t count) {
+        if (count == 0) {
+            return begin() + pos_num;
+        }
+        if (count <= Capacity() - size_) {
+            return detail::InsertInPlace(Data(), size_, pos_num, first, count);
+        }
+        if (count > MaxSize() - size_) {
+            throw std::length_error("SmallVector capacity overflow");
+        }
+        RawMemory<T, Allocator> new_data(GrowthCapacity(size_ + count), GetAllocator());
+        std::uninitialized_copy_n(first, count, new_data.GetAddress() + pos_num);
+        detail::UninitializedRelocateWithGap(Data(), size_, pos_num, count, new_data.GetAddress());
+        heap_.Swap(new_data);
+        size_ += count;
+        return begin() + pos_num;
+    }
+
+    // Пустой heap_ означает, что элементы находятся во встроенном буфере
+    RawMemory<T, Allocator> heap_;
+    size_t size_ = 0;
+    alignas(T) unsigned char inline_buffer_[N * sizeof(T)];
+};
+
+template <typename T, size_t N, typename Allocator, typename GrowthPolicy, typename Predicate>
+size_t EraseIf(SmallVector<T, N, Allocator, GrowthPolicy>& v, Predicate pred) {
+    const auto new_end = std::remove_if(v.begin(), v.end(), pred);
+    const size_t removed = v.end() - new_end;
+    v.Erase(new_end, v.end());
+    return removed;
+}
@@ -0,0 +1,473 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Непрерывный участок одного столбца SoaVector (аналог std::span из C++20)
+template <typename T>
+class ColumnSpan {
+public:
+    using value_type = std::remove_const_t<T>;
+    using iterator = T*;
+
+    ColumnSpan() = default;
+
+    ColumnSpan(T* data, size_t size) noexcept
+        : data_(data)
+        , size_(size) {
+    }
+
+    // Неконстантный участок приводится к константному
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T>>>
+    ColumnSpan(const ColumnSpan<U>& other) noexcept
+        : data_(other.Data())
+        , size_(other.Size()) {
+    }
+
+    T* begin() const noexcept {
+        return data_;
+    }
+    T* end() const noexcept {
+        return data_ + size_;
+    }
+
+    T& operator[](size_t index) const noexcept {
+        VECTOR_CHECK(index < size_, "index %zu out of range for size %zu", index, size_);
+        return data_[index];
+    }
+
+    T* Data() const noexcept {
+        return data_;
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Вектор записей, хранящий каждое поле в отдельном буфере (структура массивов). Циклы, читающие
+// одно-два поля, проходят только по нужным столбцам: кэш-линии заполнены полезными данными,
+// а плоские массивы векторизуются компилятором. Все столбцы растут вместе по политике GrowthPolicy.
+// Столбец I доступен как ColumnSpan через Column<I>(), строка — как кортеж ссылок на поля.
+// Гарантии безопасности исключений те же, что у Vector
+template <typename... Fields>
+class SoaVector {
+    static_assert(sizeof...(Fields) != 0, "SoaVector needs at least one field");
+
+    static constexpr size_t COLUMN_COUNT = sizeof...(Fields);
+
+    template <size_t I>
+    using Field = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    using Columns = std::tuple<RawMemory<Fields>...>;
+    using GrowthPolicy = DoublingGrowth;
+
+    template <bool IsConst>
+    class BasicRowIterator;
+
+public:
+    using Row = std::tuple<Fields&...>;
+    using ConstRow = std::tuple<const Fields&...>;
+    using iterator = BasicRowIterator<false>;
+    using const_iterator = BasicRowIterator<true>;
+
+    SoaVector() = default;
+
+    // Конструкторы делегируют пустому вектору, чтобы при исключении деструктор разрушил созданные элементы
+    explicit SoaVector(size_t size)
+        : SoaVector() {
+        Resize(size);
+    }
+
+    SoaVector(const SoaVector& other)
+        : SoaVector() {
+        Columns new_columns = AllocateColumns(other.size_);
+        CopyColumns<0>(other.columns_, new_columns, other.size_);
+        columns_ = std::move(new_columns);
+        size_ = other.size_;
+        capacity_ = other.size_;
+    }
+
+    SoaVector(SoaVector&& other) noexcept
+        : columns_(std::move(other.columns_))
+        , size_(std::exchange(other.size_, 0))
+        , capacity_(std::exchange(other.capacity_, 0)) {
+    }
+
+    SoaVector& operator=(const SoaVector& rhs) {
+        if (this != &rhs) {
+            SoaVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    SoaVector& operator=(SoaVector&& rhs) noexcept {
+        if (this != &rhs) {
+            SoaVector rhs_copy(std::move(rhs));
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    ~SoaVector() {
+        DestroyRows(0, size_);
+    }
+
+    void Swap(SoaVector& other) noexcept {
+        ForEachColumn([&](auto column) {
+            std::get<column>(columns_).Swap(std::get<column>(other.columns_));
+        });
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return capacity_;
+    }
+
+    size_t MaxSize() const noexcept {
+        return std::numeric_limits<std::ptrdiff_t>::max() / std::max({sizeof(Fields)...});
+    }
+
+    // Столбец элементов поля I
+    template <size_t I>
+    ColumnSpan<Field<I>> Column() noexcept {
+        return {std::get<I>(columns_).GetAddress(), size_};
+    }
+
+    template <size_t I>
+    ColumnSpan<const Field<I>> Column() const noexcept {
+        return {std::get<I>(columns_).GetAddress(), size_};
+    }
+
+    // Строка index как кортеж ссылок на её поля
+    Row operator[](size_t index) noexcept {
+        VECTOR_CHECK(index < size_, "index %zu out of range for size %zu", index, size_);
+        return RowAt(index, std::index_sequence_for<Fields...>{});
+    }
+
+    ConstRow operator[](size_t index) const noexcept {
+        VECTOR_CHECK(index < size_, "index %zu out of range for size %zu", index, size_);
+        return const_cast<SoaVector&>(*this).RowAt(index, std::index_sequence_for<Fields...>{});
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+    iterator end() noexcept {
+        return iterator(this, size_);
+    }
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(this, size_);
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= capacity_) {
+            return;
+        }
+        if (new_capacity > MaxSize()) {
+            throw std::length_error("SoaVector capacity overflow");
+        }
+        ReallocateTo(new_capacity);
+    }
+
+    void ShrinkToFit() {
+        if (capacity_ != size_) {
+            ReallocateTo(size_);
+        }
+    }
+
+    void Clear() noexcept {
+        DestroyRows(0, size_);
+        size_ = 0;
+    }
+
+    // Новые строки инициализируются значениями по умолчанию. При исключении вектор не меняется
+    void Resize(size_t new_size) {
+        if (new_size <= size_) {
+            DestroyRows(new_size, size_);
+            size_ = new_size;
+            return;
+        }
+        if (new_size > capacity_) {
+            Reserve(GrowthCapacity(new_size));
+        }
+        ValueConstructColumns<0>(columns_, size_, new_size - size_);
+        size_ = new_size;
+    }
+
+    // Добавляет строку, поля которой создаются из соответствующих аргументов.
+    // Аргументы могут ссылаться на элементы этого же вектора
+    template <typename... Args>
+    Row EmplaceBack(Args&&... args) {
+        static_assert(sizeof...(Args) == COLUMN_COUNT, "EmplaceBack takes one argument per field");
+        auto arg_tuple = std::forward_as_tuple(std::forward<Args>(args)...);
+        if (size_ == capacity_) {
+            const size_t new_capacity = GrowthCapacity(size_ + 1);
+            Columns new_columns = AllocateColumns(new_capacity);
+            ConstructRow<0>(new_columns, size_, arg_tuple);
+            try {
+                RelocateColumns(new_columns);
+            }
+            catch (...) {
+                DestroyRow(new_columns, size_);
+                throw;
+            }
+            columns_ = std::move(new_columns);
+            capacity_ = new_capacity;
+        } else {
+            ConstructRow<0>(columns_, size_, arg_tuple);
+        }
+        ++size_;
+        return (*this)[size_ - 1];
+    }
+
+    void PushBack(const Fields&... fields) {
+        EmplaceBack(fields...);
+    }
+
+    void PopBack() noexcept {
+        VECTOR_CHECK(size_ > 0, "PopBack on empty vector");
+        DestroyRow(columns_, --size_);
+    }
+
+private:
+    template <typename F>
+    static void ForEachColumn(F&& f) {
+        ForEachColumnImpl(f, std::index_sequence_for<Fields...>{});
+    }
+
+    template <typename F, size_t... I>
+    static void ForEachColumnImpl(F& f, std::index_sequence<I...>) {
+        (f(std::integral_constant<size_t, I>{}), ...);
+    }
+
+    template <size_t... I>
+    Row RowAt(size_t index, std::index_sequence<I...>) noexcept {
+        return Row(std::get<I>(columns_)[index]...);
+    }
+
+    size_t GrowthCapacity(size_t required) const {
+        return GrowthPolicy::NextCapacity(capacity_, required, (sizeof(Fields) + ...), MaxSize());
+    }
+
+    // Выделяет буферы всех столбцов. При нехватке памяти уже выделенные буферы освобождаются
+    static Columns AllocateColumns(size_t capacity) {
+        return Columns(RawMemory<Fields>(capacity)...);
+    }
+
+    static void DestroyRow(Columns& columns, size_t index) noexcept {
+        ForEachColumn([&](auto column) {
+            std::destroy_at(std::get<column>(columns).GetAddress() + index);
+        });
+    }
+
+    void DestroyRows(size_t first, size_t last) noexcept {
+        ForEachColumn([&](auto column) {
+            std::destroy_n(std::get<column>(columns_).GetAddress() + first, last - first);
+        });
+    }
+
+    // Создаёт поля строки index в столбцах начиная с I. При исключении созданные поля разрушаются
+    template <size_t I, typename ArgTuple>
+    static void ConstructRow(Columns& columns, size_t index, ArgTuple& args) {
+        if constexpr (I < COLUMN_COUNT) {
+            Field<I>* field = new (std::get<I>(columns).GetAddress() + index)
+                Field<I>(std::forward<std::tuple_element_t<I, ArgTuple>>(std::get<I>(args)));
+            try {
+                ConstructRow<I + 1>(columns, index, args);
+            }
+            catch (...) {
+                std::destroy_at(field);
+                throw;
+            }
+        }
+    }
+
+    // Создаёт по count значений по умолчанию в столбцах начиная с I, с позиции first
+    template <size_t I>
+    static void ValueConstructColumns(Columns& columns, size_t first, size_t count) {
+        if constexpr (I < COLUMN_COUNT) {
+            Field<I>* data = std::get<I>(columns).GetAddress() + first;
+            std::uninitialized_value_construct_n(data, count);
+            try {
+                ValueConstructColumns<I + 1>(columns, first, count);
+            }
+            catch (...) {
+                std::destroy_n(data, count);
+                throw;
+            }
+        }
+    }
+
+    // Копирует size строк из столбцов from в неинициализированные столбцы to начиная с I.
+    // Если OnlyCopiedOnRelocation, копируются только столбцы, которые Vector переносил бы копированием
+    template <size_t I, bool OnlyCopiedOnRelocation = false>
+    static void CopyColumns(const Columns& from, Columns& to, size_t size) {
+        if constexpr (I < COLUMN_COUNT) {
+            constexpr bool copy = !OnlyCopiedOnRelocation || relocates_by_copy_v<Field<I>>;
+            if constexpr (copy) {
+                std::uninitialized_copy_n(std::get<I>(from).GetAddress(), size, std::get<I>(to).GetAddress());
+            }
+            try {
+                CopyColumns<I + 1, OnlyCopiedOnRelocation>(from, to, size);
+            }
+            catch (...) {
+                if constexpr (copy) {
+                    std::destroy_n(std::get<I>(to).GetAddress(), size);
+                }
+                throw;
+            }
+        }
+    }
+
+    // Переносит строки в новые столбцы. Сначала копируются столбцы, перенос которых может выбросить
+    // исключение, и лишь затем, когда исключений уже не будет, перемещаются остальные. Поэтому при
+    // исключении старые столбцы остаются нетронутыми
+    void RelocateColumns(Columns& new_columns) {
+        CopyColumns<0, true>(columns_, new_columns, size_);
+        ForEachColumn([&](auto column) {
+            auto* from = std::get<column>(columns_).GetAddress();
+            if constexpr (relocates_by_copy_v<std::remove_pointer_t<decltype(from)>>) {
+                std::destroy_n(from, size_);
+            } else {
+                detail::UninitializedRelocateN(from, size_, std::get<column>(new_columns).GetAddress());
+            }
+        });
+    }
+
+    void ReallocateTo(size_t new_capacity) {
+        assert(new_capacity >= size_);
+        Columns new_columns = AllocateColumns(new_capacity);
+        RelocateColumns(new_columns);
+        columns_ = std::move(new_columns);
+        capacity_ = new_capacity;
+    }
+
+    Columns columns_;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+};
+
+// Итератор строк с произвольным доступом. Это итератор-заместитель: reference — не value_type&, а временный
+// кортеж ссылок на поля строки (Row или ConstRow), поэтому работают структурные привязки и изменение полей
+// через него, но ссылку на саму строку сохранить нельзя, а pointer и operator-> отсутствуют
+template <typename... Fields>
+template <bool IsConst>
+class SoaVector<Fields...>::BasicRowIterator {
+    using VectorPtr = std::conditional_t<IsConst, const SoaVector*, SoaVector*>;
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::tuple<Fields...>;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::conditional_t<IsConst, ConstRow, Row>;
+    using pointer = void;
+
+    BasicRowIterator() = default;
+
+    BasicRowIterator(VectorPtr vector, size_t index) noexcept
+        : vector_(vector)
+        , index_(index) {
+    }
+
+    reference operator*() const noexcept {
+        return (*vector_)[index_];
+    }
+    reference operator[](difference_type offset) const noexcept {
+        return *(*this + offset);
+    }
+
+    // Индекс строки в векторе
+    size_t Index() const noexcept {
+        return index_;
+    }
+
+    BasicRowIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+    BasicRowIterator operator++(int) noexcept {
+        BasicRowIterator result = *this;
+        ++index_;
+        return result;
+    }
+    BasicRowIterator& operator--() noexcept {
+        --index_;
+        return *this;
+    }
+    BasicRowIterator operator--(int) noexcept {
+        BasicRowIterator result = *this;
+        --index_;
+        return result;
+    }
+    BasicRowIterator& operator+=(difference_type offset) noexcept {
+        index_ += offset;
+        return *this;
+    }
+    BasicRowIterator& operator-=(difference_type offset) noexcept {
+        index_ -= offset;
+        return *this;
+    }
+    friend BasicRowIterator operator+(BasicRowIterator it, difference_type offset) noexcept {
+        return it += offset;
+    }
+    friend BasicRowIterator operator+(difference_type offset, BasicRowIterator it) noexcept {
+        return it += offset;
+    }
+    friend BasicRowIterator operator-(BasicRowIterator it, difference_type offset) noexcept {
+        return it -= offset;
+    }
+    friend difference_type operator-(const BasicRowIterator& lhs, const BasicRowIterator& rhs) noexcept {
+        return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+    friend bool operator==(const BasicRowIterator& lhs, const BasicRowIterator& rhs) noexcept {
+        return lhs.vector_ == rhs.vector_ && lhs.index_ == rhs.index_;
+    }
+    friend bool operator!=(const BasicRowIterator& lhs, const BasicRowIterator& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+    friend bool operator<(const BasicRowIterator& lhs, const BasicRowIterator& rhs) noexcept {
+        return lhs.index_ < rhs.index_;
+    }
+    friend bool operator>(const BasicRowIterator& lhs, const BasicRowIterator& rhs) noexcept {
+        return rhs < lhs;
+    }
+    friend bool operator<=(const BasicRowIterator& lhs, const BasicRowIterator& rhs) noexcept {
+        return !(rhs < lhs);
+    }
+    friend bool operator>=(const BasicRowIterator& lhs, const BasicRowIterator& rhs) noexcept {
+        return !(lhs < rhs);
+    }
+
+private:
+    VectorPtr vector_ = nullptr;
+    size_t index_ = 0;
+};
@@ -0,0 +1,419 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+// Число элементов в куске StableVector: степень двойки, не меньше 16 элементов и 4 КБ
+template <typename T>
+constexpr size_t DefaultChunkSize() noexcept {
+    size_t size = 16;
+    while (size * sizeof(T) < 4096) {
+        size *= 2;
+    }
+    return size;
+}
+
+}  // namespace detail
+
+// Вектор, хранящий элементы в кусках фиксированного размера ChunkSize (RawMemory), адреса которых
+// хранятся в таблице кусков. Индексация — O(1) через таблицу, добавление в конец выделяет новый кусок,
+// не перемещая ни одного элемента. Поэтому указатели, ссылки и итераторы на элементы остаются
+// действительными при росте и инвалидируются только удалением самих элементов или перемещением вектора.
+// Интерфейс повторяет Vector; для быстрых проходов удобен ForEachChunk, отдающий куски целиком
+template <typename T, typename Allocator = std::allocator<T>, size_t ChunkSize = detail::DefaultChunkSize<T>()>
+class StableVector {
+    static_assert(ChunkSize != 0 && (ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of two");
+
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using Chunk = RawMemory<T, Allocator>;
+    using ChunkTable = Vector<Chunk, typename AllocTraits::template rebind_alloc<Chunk>>;
+
+    template <bool IsConst>
+    class BasicIterator;
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    static constexpr size_t CHUNK_SIZE = ChunkSize;
+
+    StableVector() = default;
+
+    explicit StableVector(const Allocator& alloc) noexcept
+        : alloc_(alloc)
+        , chunks_(typename ChunkTable::allocator_type(alloc)) {
+    }
+
+    // Конструкторы делегируют пустому вектору, чтобы при исключении деструктор разрушил созданные элементы
+    explicit StableVector(size_t size, const Allocator& alloc = Allocator())
+        : StableVector(alloc) {
+        Resize(size);
+    }
+
+    StableVector(const StableVector& other)
+        : StableVector(other, AllocTraits::select_on_container_copy_construction(other.GetAllocator())) {
+    }
+
+    StableVector(const StableVector& other, const Allocator& alloc)
+        : StableVector(alloc) {
+        Reserve(other.size_);
+        other.ForEachChunk([this](const T* data, size_t count) {
+            std::uninitialized_copy_n(data, count, ChunkData(size_ / ChunkSize));
+            size_ += count;
+        });
+    }
+
+    StableVector(StableVector&& other) noexcept
+        : alloc_(other.alloc_)
+        , chunks_(std::move(other.chunks_))
+        , size_(std::exchange(other.size_, 0)) {
+    }
+
+    StableVector& operator=(const StableVector& rhs) {
+        if (this != &rhs) {
+            StableVector rhs_copy(rhs, AllocTraits::propagate_on_container_copy_assignment::value
+                                           ? rhs.GetAllocator()
+                                           : GetAllocator());
+            Clear();
+            TakeChunks(rhs_copy);
+        }
+        return *this;
+    }
+
+    StableVector& operator=(StableVector&& rhs) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                                         || AllocTraits::is_always_equal::value) {
+        if (this != &rhs) {
+            if (AllocTraits::propagate_on_container_move_assignment::value || GetAllocator() == rhs.GetAllocator()) {
+                Clear();
+                TakeChunks(rhs);
+            } else {
+                // куски rhs нельзя освободить нашим аллокатором, поэтому перемещаем поэлементно
+                Clear();
+                Reserve(rhs.size_);
+                rhs.ForEachChunk([this](T* data, size_t count) {
+                    std::uninitialized_move_n(data, count, ChunkData(size_ / ChunkSize));
+                    size_ += count;
+                });
+            }
+        }
+        return *this;
+    }
+
+    ~StableVector() {
+        Clear();
+    }
+
+    iterator begin() noexcept {
+        return iterator(&chunks_, 0);
+    }
+    iterator end() noexcept {
+        return iterator(&chunks_, size_);
+    }
+    const_iterator begin() const noexcept {
+        return const_iterator(&chunks_, 0);
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(&chunks_, size_);
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<StableVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        VECTOR_CHECK(index < size_, "index %zu out of range for size %zu", index, size_);
+        return chunks_[index / ChunkSize][index % ChunkSize];
+    }
+
+    // Вызывает f(data, count) для каждого куска элементов по порядку: data указывает на count
+    // подряд расположенных элементов. Позволяет обрабатывать элементы плоскими циклами
+    template <typename F>
+    void ForEachChunk(F f) {
+        for (size_t first = 0; first < size_; first += ChunkSize) {
+            f(ChunkData(first / ChunkSize), std::min(ChunkSize, size_ - first));
+        }
+    }
+
+    template <typename F>
+    void ForEachChunk(F f) const {
+        for (size_t first = 0; first < size_; first += ChunkSize) {
+            f(static_cast<const T*>(chunks_[first / ChunkSize].GetAddress()), std::min(ChunkSize, size_ - first));
+        }
+    }
+
+    void Swap(StableVector& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        }
+        chunks_.Swap(other.chunks_);
+        std::swap(size_, other.size_);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return chunks_.Size() * ChunkSize;
+    }
+
+    size_t MaxSize() const noexcept {
+        return std::min<size_t>(AllocTraits::max_size(alloc_), std::numeric_limits<std::ptrdiff_t>::max() / sizeof(T));
+    }
+
+    const Allocator& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // Выделяет куски, достаточные для new_capacity элементов. Элементы не перемещаются
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+        if (new_capacity > MaxSize()) {
+            throw std::length_error("StableVector capacity overflow");
+        }
+        const size_t chunk_count = (new_capacity + ChunkSize - 1) / ChunkSize;
+        chunks_.Reserve(chunk_count);
+        while (chunks_.Size() < chunk_count) {
+            chunks_.EmplaceBack(ChunkSize, alloc_);
+        }
+    }
+
+    // Освобождает куски, не занятые элементами
+    void ShrinkToFit() {
+        const size_t chunk_count = (size_ + ChunkSize - 1) / ChunkSize;
+        chunks_.Erase(chunks_.begin() + chunk_count, chunks_.end());
+        chunks_.ShrinkToFit();
+    }
+
+    // Удаляет все элементы, сохраняя куски
+    void Clear() noexcept {
+        Truncate(0);
+    }
+
+    // Удаляет все элементы и освобождает куски
+    void ClearAndRelease() noexcept {
+        Clear();
+        chunks_.ClearAndRelease();
+    }
+
+    // При исключении созданные элементы удаляются, и размер вектора не меняется
+    void Resize(size_t new_size) {
+        GrowFilled(new_size, [](T* dst, size_t count) {
+            std::uninitialized_value_construct_n(dst, count);
+        });
+    }
+
+    // value может быть элементом этого же вектора: при росте элементы не перемещаются
+    void Resize(size_t new_size, const T& value) {
+        GrowFilled(new_size, [&value](T* dst, size_t count) {
+            std::uninitialized_fill_n(dst, count, value);
+        });
+    }
+
+    // Добавляет элемент в конец, при необходимости выделяя новый кусок. Существующие элементы
+    // не перемещаются, поэтому args могут ссылаться на них
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            if (size_ == MaxSize()) {
+                throw std::length_error("StableVector capacity overflow");
+            }
+            chunks_.EmplaceBack(ChunkSize, alloc_);
+        }
+        T* value = new (ChunkData(size_ / ChunkSize) + size_ % ChunkSize) T(std::forward<Args>(args)...);
+        ++size_;
+        return *value;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack() noexcept {
+        VECTOR_CHECK(size_ > 0, "PopBack on empty vector");
+        --size_;
+        std::destroy_at(ChunkData(size_ / ChunkSize) + size_ % ChunkSize);
+    }
+
+private:
+    T* ChunkData(size_t chunk) noexcept {
+        return chunks_[chunk].GetAddress();
+    }
+
+    // Разрушает элементы начиная с new_size (new_size <= Size()), куски сохраняются
+    void Truncate(size_t new_size) noexcept {
+        while (size_ > new_size) {
+            const size_t chunk_first = (size_ - 1) / ChunkSize * ChunkSize;
+            const size_t first = std::max(chunk_first, new_size);
+            std::destroy_n(ChunkData(chunk_first / ChunkSize) + (first - chunk_first), size_ - first);
+            size_ = first;
+        }
+    }
+
+    // Увеличивает размер до new_size, создавая элементы вызовом fill(dst, count) по кускам
+    template <typename Fill>
+    void GrowFilled(size_t new_size, Fill fill) {
+        if (new_size <= size_) {
+            Truncate(new_size);
+            return;
+        }
+        Reserve(new_size);
+        const size_t old_size = size_;
+        try {
+            while (size_ < new_size) {
+                const size_t offset = size_ % ChunkSize;
+                const size_t count = std::min(ChunkSize - offset, new_size - size_);
+                fill(ChunkData(size_ / ChunkSize) + offset, count);
+                size_ += count;
+            }
+        }
+        catch (...) {
+            Truncate(old_size);
+            throw;
+        }
+    }
+
+    // Забирает куски other (элементы этого вектора уже разрушены)
+    void TakeChunks(StableVector& other) noexcept {
+        assert(size_ == 0);
+        chunks_ = std::move(other.chunks_);
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value
+                      || AllocTraits::propagate_on_container_copy_assignment::value) {
+            alloc_ = other.alloc_;
+        }
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    [[no_unique_address]] Allocator alloc_;
+    ChunkTable chunks_;
+    size_t size_ = 0;
+};
+
+// Итератор произвольного доступа по элементам: индекс элемента и таблица кусков. Итератор ссылается
+// на саму таблицу, а не на её буфер, поэтому остаётся действительным, когда таблица растёт
+template <typename T, typename Allocator, size_t ChunkSize>
+template <bool IsConst>
+class StableVector<T, Allocator, ChunkSize>::BasicIterator {
+    using ChunkTablePtr = std::conditional_t<IsConst, const ChunkTable*, ChunkTable*>;
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<IsConst, const T*, T*>;
+    using reference = std::conditional_t<IsConst, const T&, T&>;
+
+    BasicIterator() = default;
+
+    BasicIterator(ChunkTablePtr chunks, size_t index) noexcept
+        : chunks_(chunks)
+        , index_(index) {
+    }
+
+    // Неконстантный итератор приводится к константному
+    template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+    BasicIterator(const BasicIterator<OtherConst>& other) noexcept
+        : chunks_(other.chunks_)
+        , index_(other.index_) {
+    }
+
+    reference operator*() const noexcept {
+        return *((*chunks_)[index_ / ChunkSize].GetAddress() + index_ % ChunkSize);
+    }
+    pointer operator->() const noexcept {
+        return &**this;
+    }
+    reference operator[](difference_type offset) const noexcept {
+        return *(*this + offset);
+    }
+
+    BasicIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+    BasicIterator operator++(int) noexcept {
+        BasicIterator result = *this;
+        ++index_;
+        return result;
+    }
+    BasicIterator& operator--() noexcept {
+        --index_;
+        return *this;
+    }
+    BasicIterator operator--(int) noexcept {
+        BasicIterator result = *this;
+        --index_;
+        return result;
+    }
+    BasicIterator& operator+=(difference_type offset) noexcept {
+        index_ += offset;
+        return *this;
+    }
+    BasicIterator& operator-=(difference_type offset) noexcept {
+        index_ -= offset;
+        return *this;
+    }
+    friend BasicIterator operator+(BasicIterator it, difference_type offset) noexcept {
+        return it += offset;
+    }
+    friend BasicIterator operator+(difference_type offset, BasicIterator it) noexcept {
+        return it += offset;
+    }
+    friend BasicIterator operator-(BasicIterator it, difference_type offset) noexcept {
+        return it -= offset;
+    }
+    friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+
+    friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return lhs.index_ == rhs.index_;
+    }
+    friend bool operator!=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return lhs.index_ != rhs.index_;
+    }
+    friend bool operator<(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return lhs.index_ < rhs.index_;
+    }
+    friend bool operator>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return rhs < lhs;
+    }
+    friend bool operator<=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return !(rhs < lhs);
+    }
+    friend bool operator>=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+        return !(lhs < rhs);
+    }
+
+private:
+    template <bool>
+    friend class BasicIterator;
+
+    ChunkTablePtr chunks_ = nullptr;
+    size_t index_ = 0;
+};
@@ -1,318 +1,1877 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cstdarg>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
 #include <memory>
 #include <new>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <typeinfo>
 #include <utility>
 
+#include "demangle.h"
+
+#ifdef VECTOR_ENABLE_STATS
+#include "vector_stats.h"
+#endif
+
+// Признак того, что объект типа T можно перенести в другую область памяти побайтовым копированием,
+// не вызывая конструктор перемещения у нового объекта и деструктор у старого.
+// Для своих типов (например, хэндлов, владеющих ресурсом) его можно специализировать:
+// template <> struct is_trivially_relocatable<MyHandle> : std::true_type {};
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+struct is_trivially_relocatable<std::unique_ptr<T, std::default_delete<T>>> : std::true_type {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+// Истинно, если при перевыделении буфера элементы типа T копируются, а не перемещаются:
+// конструктор перемещения может выбросить исключение, и перемещение нарушило бы строгую гарантию.
+// Для типов с дорогим копированием (строки, контейнеры) это обычно означает забытый noexcept.
+// Если определить макрос VECTOR_STRICT_NOEXCEPT_MOVE, перевыделение буфера с такими элементами
+// не скомпилируется. По умолчанию в отладочной сборке (без NDEBUG) о каждом таком типе однократно
+// сообщается в stderr; сообщение отключается макросом VECTOR_COPY_FALLBACK_DIAGNOSTIC=0
+template <typename T>
+inline constexpr bool relocates_by_copy_v = !is_trivially_relocatable_v<T>
+                                            && !std::is_nothrow_move_constructible_v<T>
+                                            && std::is_copy_constructible_v<T>;
+
+#ifndef VECTOR_COPY_FALLBACK_DIAGNOSTIC
+#ifdef NDEBUG
+#define VECTOR_COPY_FALLBACK_DIAGNOSTIC 0
+#else
+#define VECTOR_COPY_FALLBACK_DIAGNOSTIC 1
+#endif
+#endif
+
+// Уровень проверок корректности обращений к контейнерам (VECTOR_CHECK_LEVEL):
+// 0 — проверок нет (по умолчанию при NDEBUG);
+// 1 — дешёвые проверки: индекс operator[] и позиции Emplace/Insert/Erase
+//     (по умолчанию без NDEBUG). Каждая стоит одного сравнения с почти никогда не выполняемым переходом;
+// 2 — полные проверки: дополнительно проверяются смещения во внутренних буферах (RawMemory),
+//     а Vector ведёт счётчик поколений буфера (Generation), увеличиваемый при каждом перевыделении,
+//     и выдаёт CheckedIterator, которые по нему обнаруживают обращение через итератор, пережившее
+//     перевыделение буфера (уровень 2 определяет VECTOR_CHECKED_ITERATORS).
+// На других уровнях такие итераторы включаются отдельно макросом VECTOR_CHECKED_ITERATORS.
+// О нарушении сообщается в stderr с местом и значениями, после чего программа завершается через abort
+#ifndef VECTOR_CHECK_LEVEL
+#ifdef NDEBUG
+#define VECTOR_CHECK_LEVEL 0
+#else
+#define VECTOR_CHECK_LEVEL 1
+#endif
+#endif
+
+#if VECTOR_CHECK_LEVEL >= 2 && !defined(VECTOR_CHECKED_ITERATORS)
+#define VECTOR_CHECKED_ITERATORS
+#endif
+
+// VECTOR_CONSTEXPR отмечает операции Vector, доступные при вычислении на этапе компиляции (C++20,
+// constexpr std::allocator). Вектор, созданный при компиляции, там же и разрушается; его содержимое
+// переносится в программу через FreezeVector. В C++17 макрос пуст, а VECTOR_HAS_CONSTEXPR равен 0
+#if defined(__cpp_lib_constexpr_dynamic_alloc) && __cpp_lib_constexpr_dynamic_alloc >= 201907L
+#define VECTOR_HAS_CONSTEXPR 1
+#define VECTOR_CONSTEXPR constexpr
+#else
+#define VECTOR_HAS_CONSTEXPR 0
+#define VECTOR_CONSTEXPR
+#endif
+
+// Подсказки компилятору для горячих путей: вероятность условия и вынос редкой ветки из места вызова
+#if defined(__GNUC__)
+#define VECTOR_LIKELY(condition) __builtin_expect(!!(condition), 1)
+#define VECTOR_UNLIKELY(condition) __builtin_expect(!!(condition), 0)
+#define VECTOR_NOINLINE __attribute__((noinline))
+#else
+#define VECTOR_LIKELY(condition) (condition)
+#define VECTOR_UNLIKELY(condition) (condition)
+#define VECTOR_NOINLINE
+#endif
+
+// VECTOR_CHECK(условие, формат, аргументы...) — проверка уровня 1, VECTOR_FULL_CHECK — уровня 2.
+// Аргументы сообщения вычисляются только при нарушении
+#define VECTOR_CHECK_IMPL(condition, ...)                                   \
+    do {                                                                    \
+        if (VECTOR_UNLIKELY(!(condition))) {                                \
+            ::detail::CheckFailed(__FILE__, __LINE__, #condition, __VA_ARGS__); \
+        }                                                                   \
+    } while (false)
+
+#if VECTOR_CHECK_LEVEL >= 1
+#define VECTOR_CHECK(condition, ...) VECTOR_CHECK_IMPL(condition, __VA_ARGS__)
+#else
+#define VECTOR_CHECK(condition, ...) ((void)0)
+#endif
+
+#if VECTOR_CHECK_LEVEL >= 2
+#define VECTOR_FULL_CHECK(condition, ...) VECTOR_CHECK_IMPL(condition, __VA_ARGS__)
+#else
+#define VECTOR_FULL_CHECK(condition, ...) ((void)0)
+#endif
+
+namespace detail {
+
+// Сообщает о нарушенной проверке и завершает программу. Вынесена из места проверки,
+// чтобы код сообщения не попадал на горячий путь
+#if defined(__GNUC__)
+[[noreturn]] __attribute__((noinline, cold, format(printf, 4, 5)))
+#else
+[[noreturn]]
+#endif
+inline void CheckFailed(const char* file, int line, const char* condition, const char* format, ...) noexcept {
+    std::fprintf(stderr, "%s:%d: vector check failed: ", file, line);
+    std::va_list args;
+    va_start(args, format);
+    std::vfprintf(stderr, format, args);
+    va_end(args);
+    std::fprintf(stderr, " (%s)\n", condition);
+    std::fflush(stderr);
+    std::abort();
+}
+
+// Выполняется ли код при вычислении на этапе компиляции. Там недоступны побайтовые копирования,
+// статистика и диагностика, и операции заменяют их поэлементными
+constexpr bool IsConstantEvaluated() noexcept {
+#if VECTOR_HAS_CONSTEXPR
+    return std::is_constant_evaluated();
+#else
+    return false;
+#endif
+}
+
+// Конструирует объект в неинициализированной памяти; в отличие от размещающего new допустимо в constexpr
+template <typename T, typename... Args>
+VECTOR_CONSTEXPR T* ConstructAt(T* where, Args&&... args) {
+#if VECTOR_HAS_CONSTEXPR
+    return std::construct_at(where, std::forward<Args>(args)...);
+#else
+    return new (static_cast<void*>(where)) T(std::forward<Args>(args)...);
+#endif
+}
+
+// Аналоги std::uninitialized_*_n для буферов вектора. При вычислении на этапе компиляции, где
+// стандартные алгоритмы недоступны, элементы конструируются по одному через ConstructAt.
+// Возвращают конец сконструированного диапазона
+
+template <typename InputIt, typename T>
+VECTOR_CONSTEXPR T* UninitializedCopyN(InputIt first, size_t n, T* to) {
+    if (!IsConstantEvaluated()) {
+        return std::uninitialized_copy_n(first, n, to);
+    }
+    T* current = to;
+    try {
+        for (; n != 0; --n, ++first, ++current) {
+            ConstructAt(current, *first);
+        }
+    }
+    catch (...) {
+        std::destroy(to, current);
+        throw;
+    }
+    return current;
+}
+
+template <typename T>
+VECTOR_CONSTEXPR T* UninitializedMoveN(T* from, size_t n, T* to) {
+    if (!IsConstantEvaluated()) {
+        return std::uninitialized_move_n(from, n, to).second;
+    }
+    return UninitializedCopyN(std::make_move_iterator(from), n, to);
+}
+
+template <typename T>
+VECTOR_CONSTEXPR T* UninitializedFillN(T* to, size_t n, const T& value) {
+    if (!IsConstantEvaluated()) {
+        return std::uninitialized_fill_n(to, n, value);
+    }
+    T* current = to;
+    try {
+        for (; n != 0; --n, ++current) {
+            ConstructAt(current, value);
+        }
+    }
+    catch (...) {
+        std::destroy(to, current);
+        throw;
+    }
+    return current;
+}
+
+template <typename T>
+VECTOR_CONSTEXPR T* UninitializedValueConstructN(T* to, size_t n) {
+    if (!IsConstantEvaluated()) {
+        return std::uninitialized_value_construct_n(to, n);
+    }
+    T* current = to;
+    try {
+        for (; n != 0; --n, ++current) {
+            ConstructAt(current);
+        }
+    }
+    catch (...) {
+        std::destroy(to, current);
+        throw;
+    }
+    return current;
+}
+
+// Счётчик поколений буфера. Хранится только при VECTOR_CHECK_LEVEL >= 2 или VECTOR_CHECKED_ITERATORS,
+// иначе пуст и всегда равен 0
+#if VECTOR_CHECK_LEVEL >= 2 || defined(VECTOR_CHECKED_ITERATORS)
+class BufferGeneration {
+public:
+    VECTOR_CONSTEXPR void Bump() noexcept {
+        ++value_;
+    }
+    VECTOR_CONSTEXPR size_t Value() const noexcept {
+        return value_;
+    }
+
+private:
+    size_t value_ = 0;
+};
+#else
+class BufferGeneration {
+public:
+    VECTOR_CONSTEXPR void Bump() noexcept {
+    }
+    VECTOR_CONSTEXPR size_t Value() const noexcept {
+        return 0;
+    }
+};
+#endif
+
+// Обновление статистики (см. vector_stats.h). Без VECTOR_ENABLE_STATS функции пусты,
+// при вычислении на этапе компиляции статистика не ведётся
+
+template <typename T>
+VECTOR_CONSTEXPR void CountAllocation([[maybe_unused]] size_t capacity) noexcept {
+#ifdef VECTOR_ENABLE_STATS
+    if (!IsConstantEvaluated()) {
+        vector_stats::For<T>().OnAllocate(capacity);
+    }
+#endif
+}
+
 template <typename T>
+VECTOR_CONSTEXPR void CountDeallocation([[maybe_unused]] size_t capacity) noexcept {
+#ifdef VECTOR_ENABLE_STATS
+    if (!IsConstantEvaluated()) {
+        vector_stats::For<T>().OnDeallocate(capacity);
+    }
+#endif
+}
+
+// Учитывает перенос n элементов в новый буфер тем же способом, что выбирает UninitializedMoveOrCopyN.
+// Первое выделение буфера пустого вектора переносом не считается
+template <typename T>
+VECTOR_CONSTEXPR void CountRelocation([[maybe_unused]] size_t n) noexcept {
+#ifdef VECTOR_ENABLE_STATS
+    if (n == 0 || IsConstantEvaluated()) {
+        return;
+    }
+    auto& stats = vector_stats::For<T>();
+    stats.OnReallocate();
+    if constexpr (is_trivially_relocatable_v<T>) {
+        stats.OnRelocateBytes(n);
+    } else if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+        stats.OnMove(n);
+    } else {
+        stats.OnCopy(n);
+    }
+#endif
+}
+
+// Учитывает незанятые ячейки буфера разрушаемого вектора
+template <typename T>
+VECTOR_CONSTEXPR void CountRelease([[maybe_unused]] size_t capacity, [[maybe_unused]] size_t size) noexcept {
+#ifdef VECTOR_ENABLE_STATS
+    if (capacity != 0 && !IsConstantEvaluated()) {
+        vector_stats::For<T>().OnRelease(capacity, size);
+    }
+#endif
+}
+
+// Сообщает (однократно для каждого типа), что элементы T переносятся копированием
+template <typename T>
+void ReportCopyFallback() noexcept {
+#if VECTOR_COPY_FALLBACK_DIAGNOSTIC
+    [[maybe_unused]] static const bool reported = [] {
+        std::fprintf(stderr,
+                     "Vector: move constructor of %s is not noexcept, elements are copied on reallocation\n",
+                     DemangledName(typeid(T).name()).Get());
+        return true;
+    }();
+#endif
+}
+
+// Побайтово переносит n элементов из from в неинициализированную память to.
+// Исходные объекты после этого считаются разрушенными, деструкторы для них не вызываются.
+// На этапе компиляции перенос поэлементный: перемещение и разрушение исходного объекта
+template <typename T>
+VECTOR_CONSTEXPR void RelocateBytes(T* from, size_t n, T* to) noexcept {
+    static_assert(is_trivially_relocatable_v<T>);
+    if (IsConstantEvaluated()) {
+        for (size_t i = 0; i != n; ++i) {
+            ConstructAt(to + i, std::move(from[i]));
+            std::destroy_at(from + i);
+        }
+    } else if (n != 0) {
+        std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+    }
+}
+
+// То же, что RelocateBytes, но области памяти могут перекрываться (сдвиг элементов внутри буфера)
+template <typename T>
+VECTOR_CONSTEXPR void RelocateBytesOverlapping(T* from, size_t n, T* to) noexcept {
+    static_assert(is_trivially_relocatable_v<T>);
+    if (IsConstantEvaluated()) {
+        if (to < from) {
+            RelocateBytes(from, n, to);
+        } else if (to > from) {
+            for (size_t i = n; i != 0; --i) {
+                ConstructAt(to + i - 1, std::move(from[i - 1]));
+                std::destroy_at(from + i - 1);
+            }
+        }
+    } else if (n != 0) {
+        std::memmove(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+    }
+}
+
+// Конструирует n элементов в неинициализированной памяти to перемещением, если перемещение
+// не выбрасывает исключений (или копирование невозможно), иначе копированием
+template <typename T>
+VECTOR_CONSTEXPR void UninitializedMoveOrCopyN(T* from, size_t n, T* to) {
+    if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+        UninitializedMoveN(from, n, to);
+    } else {
+#ifdef VECTOR_STRICT_NOEXCEPT_MOVE
+        static_assert(std::is_nothrow_move_constructible_v<T>,
+                      "VECTOR_STRICT_NOEXCEPT_MOVE: element type must have a noexcept move constructor "
+                      "or be trivially relocatable");
+#endif
+        if (!IsConstantEvaluated()) {
+            ReportCopyFallback<T>();
+        }
+        UninitializedCopyN(from, n, to);
+    }
+}
+
+// Переносит n элементов из from в неинициализированную память to и разрушает исходные.
+// Если при копировании возникнет исключение, исходные элементы останутся нетронутыми
+template <typename T>
+VECTOR_CONSTEXPR void UninitializedRelocateN(T* from, size_t n, T* to) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+        RelocateBytes(from, n, to);
+    } else {
+        UninitializedMoveOrCopyN(from, n, to);
+        std::destroy_n(from, n);
+    }
+    CountRelocation<T>(n);
+}
+
+// Переносит size элементов из src в неинициализированную память dst, оставляя свободными count ячеек,
+// начиная с pos (в них уже сконструированы новые элементы), и разрушает исходные.
+// При исключении разрушает новые элементы, а исходные остаются нетронутыми
+template <typename T>
+VECTOR_CONSTEXPR void UninitializedRelocateWithGap(T* src, size_t size, size_t pos, size_t count, T* dst) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+        RelocateBytes(src, pos, dst);
+        RelocateBytes(src + pos, size - pos, dst + pos + count);
+    } else {
+        try {
+            UninitializedMoveOrCopyN(src, pos, dst);
+            try {
+                UninitializedMoveOrCopyN(src + pos, size - pos, dst + pos + count);
+            }
+            catch (...) {
+                std::destroy_n(dst, pos);
+                throw;
+            }
+        }
+        catch (...) {
+            std::destroy_n(dst + pos, count);
+            throw;
+        }
+        std::destroy_n(src, size);
+    }
+    CountRelocation<T>(size);
+}
+
+// Далее — операции над элементами буфера data, содержащего size элементов, которым хватает
+// вместимости буфера. Их используют все векторы библиотеки, различающиеся лишь хранением буфера.
+// size обновляется по ходу операции, чтобы при исключении он соответствовал живым элементам
+
+// Сдвигает элементы [where, end) на одну ячейку перемещающими присваиваниями и присваивает
+// освободившейся ячейке новый элемент, созданный из args до сдвига
+template <typename T, typename... Args>
+VECTOR_CONSTEXPR void EmplaceByMoveAssignment(T* where, T* end, Args&&... args) {
+    T value(std::forward<Args>(args)...);
+    ConstructAt(end, std::move(*(end - 1)));
+    std::move_backward(where, end - 1, end);
+    *where = std::move(value);
+}
+
+// Конструирует элемент из args в позиции pos, сдвигая хвост на одну ячейку. Способ сдвига выбирается
+// по свойствам T: побайтовый перенос хвоста одним memmove, сдвиг перемещающими присваиваниями
+// с присваиванием нового элемента из временного объекта или, для остальных типов, сдвиг с
+// разрушением освободившейся ячейки и конструированием в ней. args могут ссылаться на элементы буфера,
+// поэтому в первых двух случаях элемент создаётся до сдвига. На этапе компиляции, где побайтовый
+// перенос недоступен, тривиально перемещаемые элементы сдвигаются присваиваниями
+template <typename T, typename... Args>
+VECTOR_CONSTEXPR T* EmplaceInPlace(T* data, size_t& size, size_t pos, Args&&... args) {
+    T* const where = data + pos;
+    T* const end = data + size;
+    if (pos == size) {
+        ConstructAt(end, std::forward<Args>(args)...);
+    } else if constexpr (is_trivially_relocatable_v<T>) {
+        if (IsConstantEvaluated()) {
+            EmplaceByMoveAssignment(where, end, std::forward<Args>(args)...);
+        } else {
+            alignas(T) unsigned char storage[sizeof(T)];
+            T* const new_value = new (storage) T(std::forward<Args>(args)...);
+            RelocateBytesOverlapping(where, size - pos, where + 1);
+            RelocateBytes(new_value, 1, where);
+        }
+    } else if constexpr (std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>) {
+        EmplaceByMoveAssignment(where, end, std::forward<Args>(args)...);
+    } else {
+        ConstructAt(end, std::move(*(end - 1)));
+        try {
+            std::move_backward(where, end - 1, end);
+        }
+        catch (...) {
+            std::destroy_at(end);
+            throw;
+        }
+        std::destroy_at(where);
+        ConstructAt(where, std::forward<Args>(args)...);
+    }
+    ++size;
+    return where;
+}
+
+// Вставляет count элементов, перечисляемых forward-итератором first, в позицию pos.
+// Хвост сдвигается ровно один раз
+template <typename T, typename ForwardIt>
+VECTOR_CONSTEXPR T* InsertInPlace(T* data, size_t& size, size_t pos, ForwardIt first, size_t count) {
+    T* const where = data + pos;
+    T* const old_end = data + size;
+    const size_t elems_after = size - pos;
+    if constexpr (is_trivially_relocatable_v<T>) {
+        // хвост сдвигается одним memmove, при исключении возвращается на место
+        RelocateBytesOverlapping(where, elems_after, where + count);
+        try {
+            UninitializedCopyN(first, count, where);
+        }
+        catch (...) {
+            RelocateBytesOverlapping(where + count, elems_after, where);
+            throw;
+        }
+        size += count;
+    } else if (elems_after > count) {
+        UninitializedMoveN(old_end - count, count, old_end);
+        size += count;
+        std::move_backward(where, old_end - count, old_end);
+        std::copy_n(first, count, where);
+    } else {
+        ForwardIt mid = std::next(first, elems_after);
+        UninitializedCopyN(mid, count - elems_after, old_end);
+        try {
+            UninitializedMoveN(where, elems_after, where + count);
+        }
+        catch (...) {
+            std::destroy_n(old_end, count - elems_after);
+            throw;
+        }
+        size += count;
+        std::copy_n(first, elems_after, where);
+    }
+    return where;
+}
+
+// Удаляет count элементов, начиная с позиции pos, сдвигая хвост один раз
+template <typename T>
+VECTOR_CONSTEXPR void EraseInPlace(T* data, size_t& size, size_t pos, size_t count) {
+    T* const where = data + pos;
+    if constexpr (is_trivially_relocatable_v<T>) {
+        std::destroy_n(where, count);
+        RelocateBytesOverlapping(where + count, size - pos - count, where);
+    } else {
+        std::move(where + count, data + size, where);
+        std::destroy_n(data + size - count, count);
+    }
+    size -= count;
+}
+
+// Удаляет элемент в позиции pos, перемещая на его место последний элемент
+template <typename T>
+VECTOR_CONSTEXPR void UnorderedEraseInPlace(T* data, size_t& size, size_t pos) {
+    T* const target = data + pos;
+    T* const last = data + size - 1;
+    if (target != last) {
+        if constexpr (is_trivially_relocatable_v<T>) {
+            std::destroy_at(target);
+            RelocateBytes(last, 1, target);
+            --size;
+            return;
+        } else {
+            *target = std::move(*last);
+        }
+    }
+    std::destroy_at(last);
+    --size;
+}
+
+// Присваивает буферу n элементов, начиная с first (n не больше вместимости буфера).
+// Существующие элементы переприсваиваются, недостающие создаются, лишние удаляются
+template <typename T, typename InputIt>
+VECTOR_CONSTEXPR void AssignInPlace(T* data, size_t& size, InputIt first, size_t n) {
+    if (n < size) {
+        std::copy_n(first, n, data);
+        std::destroy_n(data + n, size - n);
+    } else {
+        std::copy_n(first, size, data);
+        UninitializedCopyN(std::next(first, size), n - size, data + size);
+    }
+    size = n;
+}
+
+// Заменяет содержимое буфера элементами диапазона input-итераторов, добавляя
+// не поместившиеся при помощи emplace_back
+template <typename T, typename InputIt, typename EmplaceBack>
+VECTOR_CONSTEXPR void AssignFromInput(T* data, size_t& size, InputIt first, InputIt last, EmplaceBack emplace_back) {
+    size_t assigned = 0;
+    for (; assigned != size && first != last; ++assigned, ++first) {
+        data[assigned] = *first;
+    }
+    if (assigned != size) {
+        std::destroy_n(data + assigned, size - assigned);
+        size = assigned;
+    }
+    for (; first != last; ++first) {
+        emplace_back(*first);
+    }
+}
+
+// Есть ли у аллокатора метод reallocate(ptr, old_n, new_n), изменяющий размер блока с побайтовым
+// сохранением содержимого (как realloc или mremap). См. RawMemory::Reallocate
+template <typename Allocator, typename = void>
+struct HasReallocate : std::false_type {};
+
+template <typename Allocator>
+struct HasReallocate<Allocator,
+                     std::void_t<decltype(std::declval<Allocator&>().reallocate(
+                         std::declval<typename Allocator::value_type*>(), size_t{}, size_t{}))>>
+    : std::is_same<decltype(std::declval<Allocator&>().reallocate(std::declval<typename Allocator::value_type*>(),
+                                                                 size_t{}, size_t{})),
+                   typename Allocator::value_type*> {};
+
+template <typename It>
+using IteratorCategory = typename std::iterator_traits<It>::iterator_category;
+
+template <typename It, typename = void>
+struct IsInputIterator : std::false_type {};
+
+template <typename It>
+struct IsInputIterator<It, std::void_t<IteratorCategory<It>>>
+    : std::is_convertible<IteratorCategory<It>, std::input_iterator_tag> {};
+
+template <typename It>
+inline constexpr bool is_forward_iterator_v = std::is_convertible_v<IteratorCategory<It>, std::forward_iterator_tag>;
+
+template <typename It>
+using RequireInputIterator = std::enable_if_t<IsInputIterator<It>::value>;
+
+// Итератор, возвращающий одно и то же значение count раз. Позволяет вставлять
+// count копий значения тем же кодом, что и диапазон
+template <typename T>
+class RepeatIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    constexpr RepeatIterator(const T& value, size_t index) noexcept
+        : value_(&value)
+        , index_(index) {
+    }
+
+    constexpr reference operator*() const noexcept {
+        return *value_;
+    }
+    constexpr pointer operator->() const noexcept {
+        return value_;
+    }
+    constexpr RepeatIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+    constexpr RepeatIterator operator++(int) noexcept {
+        RepeatIterator result = *this;
+        ++index_;
+        return result;
+    }
+    constexpr bool operator==(const RepeatIterator& other) const noexcept {
+        return index_ == other.index_;
+    }
+    constexpr bool operator!=(const RepeatIterator& other) const noexcept {
+        return index_ != other.index_;
+    }
+
+private:
+    const T* value_;
+    size_t index_;
+};
+
+}  // namespace detail
+
+// Признак параллельного выполнения для конструкторов и Resize, создающих много элементов.
+// Элементы создаются кусками в num_threads потоках (0 — по числу ядер), но не меньше чем по
+// min_chunk_bytes байт на поток, поэтому небольшие векторы по-прежнему создаются в одном потоке.
+// Каждый поток первым обращается к страницам своего куска, и при стандартной политике first-touch
+// страницы размещаются на узле NUMA того потока, который затем, как правило, и обрабатывает этот кусок.
+// Конструкторы элементов вызываются одновременно из разных потоков и должны это допускать
+struct ParallelPolicy {
+    static constexpr size_t DEFAULT_MIN_CHUNK_BYTES = 1024 * 1024;
+
+    size_t num_threads = 0;
+    size_t min_chunk_bytes = DEFAULT_MIN_CHUNK_BYTES;
+
+    // Число кусков, на которые следует разбить count элементов размером elem_size байт
+    size_t ChunkCount(size_t count, size_t elem_size) const noexcept {
+        const size_t threads = num_threads != 0 ? num_threads : std::max(1u, std::thread::hardware_concurrency());
+        const size_t by_size = count / std::max<size_t>(1, min_chunk_bytes / elem_size);
+        return std::max<size_t>(1, std::min(threads, by_size));
+    }
+};
+
+namespace detail {
+
+// Создаёт count элементов в неинициализированной памяти dst, вызывая construct(first, n) для кусков
+// [first, first + n) в отдельных потоках. construct должна либо создать весь кусок, либо, выбросив
+// исключение, не оставить в нём живых элементов (как std::uninitialized_*). При исключении в любом
+// куске созданные куски разрушаются, и исключение выбрасывается повторно
+template <typename T, typename ConstructChunk>
+void ParallelConstructN(T* dst, size_t count, const ParallelPolicy& policy, ConstructChunk construct) {
+    const size_t chunks = policy.ChunkCount(count, sizeof(T));
+    if (chunks <= 1) {
+        construct(size_t{0}, count);
+        return;
+    }
+
+    // границы кусков выравниваются по страницам, чтобы каждую страницу заполнял один поток
+    constexpr std::uintptr_t PAGE_SIZE = 4096;
+    const auto boundary = [&](size_t chunk) -> size_t {
+        if (chunk == chunks) {
+            return count;
+        }
+        const size_t index = count / chunks * chunk + count % chunks * chunk / chunks;
+        const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(dst);
+        const std::uintptr_t page = (base + index * sizeof(T)) / PAGE_SIZE * PAGE_SIZE;
+        return page > base ? std::min(count, static_cast<size_t>((page - base + sizeof(T) - 1) / sizeof(T))) : 0;
+    };
+
+    const std::unique_ptr<std::exception_ptr[]> errors(new std::exception_ptr[chunks]);
+    const auto run = [&](size_t chunk) noexcept {
+        try {
+            const size_t first = boundary(chunk);
+            construct(first, boundary(chunk + 1) - first);
+        }
+        catch (...) {
+            errors[chunk] = std::current_exception();
+        }
+    };
+
+    {
+        const std::unique_ptr<std::thread[]> threads(new std::thread[chunks]);
+        for (size_t chunk = 1; chunk < chunks; ++chunk) {
+            try {
+                threads[chunk] = std::thread(run, chunk);
+            }
+            catch (...) {
+                // поток создать не удалось — выполняем кусок сами
+                run(chunk);
+            }
+        }
+        run(0);
+        for (size_t chunk = 1; chunk < chunks; ++chunk) {
+            if (threads[chunk].joinable()) {
+                threads[chunk].join();
+            }
+        }
+    }
+
+    std::exception_ptr error;
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        if (errors[chunk] && !error) {
+            error = errors[chunk];
+        }
+    }
+    if (error) {
+        for (size_t chunk = 0; chunk < chunks; ++chunk) {
+            if (!errors[chunk]) {
+                const size_t first = boundary(chunk);
+                std::destroy_n(dst + first, boundary(chunk + 1) - first);
+            }
+        }
+        std::rethrow_exception(error);
+    }
+}
+
+}  // namespace detail
+
+// Политика роста вместимости вектора. При нехватке места вместимость умножается на Num / Den,
+// а первое выделение занимает не меньше MinBytes байт. Когда буфер достигает LinearAboveBytes байт,
+// рост становится линейным: по LinearAboveBytes байт за раз (0 — рост всегда геометрический)
+template <size_t Num, size_t Den, size_t MinBytes = 0, size_t LinearAboveBytes = 0>
+struct GeometricGrowth {
+    static_assert(Den != 0 && Num > Den, "Growth factor must be greater than 1");
+
+    // Вместимость не уменьшается автоматически (см. HysteresisShrink)
+    static constexpr bool AUTO_SHRINK = false;
+
+    // Возвращает новую вместимость, не меньшую required, для буфера вместимостью capacity.
+    // Результат не превышает max_size, если required > max_size, выбрасывается std::length_error
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t elem_size, size_t max_size) {
+        if (required > max_size) {
+            throw std::length_error("Vector capacity overflow");
+        }
+
+        size_t grown = max_size;
+        const size_t linear_step = LinearAboveBytes / elem_size;
+        if (LinearAboveBytes != 0 && linear_step != 0 && capacity >= linear_step) {
+            if (capacity <= max_size - linear_step) {
+                grown = capacity + linear_step;
+            }
+        } else if (capacity / Den <= max_size / Num) {
+            grown = std::min(capacity / Den * Num + capacity % Den * Num / Den, max_size);
+        }
+
+        const size_t min_capacity = std::min((MinBytes + elem_size - 1) / elem_size, max_size);
+        return std::max({required, grown, min_capacity});
+    }
+};
+
+// Удвоение вместимости: 1, 2, 4, 8...
+using DoublingGrowth = GeometricGrowth<2, 1>;
+// Рост в 1.5 раза — позволяет переиспользовать ранее освобождённые блоки
+using OneAndHalfGrowth = GeometricGrowth<3, 2>;
+// Рост примерно в золотое сечение (13 / 8)
+using GoldenRatioGrowth = GeometricGrowth<13, 8>;
+// Рост в 1.5 раза, первое выделение — не меньше кэш-линии
+using CacheLineGrowth = GeometricGrowth<3, 2, 64>;
+// Для больших буферов: рост в 1.5 раза до 64 МБ, дальше — линейный шагами по 64 МБ
+using LargeBufferGrowth = GeometricGrowth<3, 2, 64, 64 * 1024 * 1024>;
+
+// Политика Growth, дополненная автоматическим уменьшением вместимости: когда размер вектора
+// падает ниже четверти вместимости, буфер уменьшается до удвоенного размера. Разрыв между порогами
+// роста и уменьшения не даёт вектору перевыделять память при колебаниях размера около границы.
+// Уменьшение перевыделяет буфер, поэтому инвалидирует итераторы и ссылки на элементы
+template <typename Growth = DoublingGrowth>
+struct HysteresisShrink : Growth {
+    static constexpr bool AUTO_SHRINK = true;
+
+    // Возвращает вместимость, до которой следует уменьшить буфер, или capacity, если уменьшать не нужно
+    static constexpr size_t ShrinkCapacity(size_t size, size_t capacity) noexcept {
+        return size < capacity / 4 ? size * 2 : capacity;
+    }
+};
+
+template <typename T, typename Allocator = std::allocator<T>>
 class RawMemory {
+    using AllocTraits = std::allocator_traits<Allocator>;
+    static_assert(std::is_same_v<typename AllocTraits::value_type, T>);
+    static_assert(std::is_same_v<typename AllocTraits::pointer, T*>);
+
 public:
+    using allocator_type = Allocator;
+
     RawMemory() = default;
 
-    explicit RawMemory(size_t capacity)
-        : buffer_(Allocate(capacity))
+    VECTOR_CONSTEXPR explicit RawMemory(const Allocator& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    VECTOR_CONSTEXPR explicit RawMemory(size_t capacity, const Allocator& alloc = Allocator())
+        : alloc_(alloc)
+        , buffer_(Allocate(capacity))
         , capacity_(capacity) {
     }
 
-    ~RawMemory() {
-        Deallocate(buffer_);
+    VECTOR_CONSTEXPR ~RawMemory() {
+        Deallocate(buffer_, capacity_);
     }
 
     RawMemory(const RawMemory&) = delete;
     RawMemory& operator=(const RawMemory& rhs) = delete;
 
-    RawMemory(RawMemory&& other) noexcept {
-        buffer_ = nullptr;
-        capacity_ = 0;
-        std::swap(buffer_, other.buffer_);
-        std::swap(capacity_, other.capacity_);
+    VECTOR_CONSTEXPR RawMemory(RawMemory&& other) noexcept
+        : alloc_(std::move(other.alloc_))
+        , buffer_(std::exchange(other.buffer_, nullptr))
+        , capacity_(std::exchange(other.capacity_, 0)) {
     }
 
-    RawMemory& operator=(RawMemory&& rhs) noexcept {
+    // Буфер освобождается тем аллокатором, которым был выделен, поэтому аллокатор
+    // всегда переходит вместе с буфером
+    VECTOR_CONSTEXPR RawMemory& operator=(RawMemory&& rhs) noexcept {
         if (this != &rhs) {
-            Deallocate(buffer_);
-            capacity_ = 0;
-            Swap(rhs);
+            Deallocate(buffer_, capacity_);
+            alloc_ = std::move(rhs.alloc_);
+            buffer_ = std::exchange(rhs.buffer_, nullptr);
+            capacity_ = std::exchange(rhs.capacity_, 0);
         }
         return *this;
     }
 
-    T* operator+(size_t offset) noexcept {
+    VECTOR_CONSTEXPR T* operator+(size_t offset) noexcept {
         // Разрешается получать адрес ячейки памяти, следующей за последним элементом массива
-        assert(offset <= capacity_);
+        VECTOR_FULL_CHECK(offset <= capacity_, "offset %zu exceeds buffer capacity %zu", offset, capacity_);
         return buffer_ + offset;
     }
 
-    const T* operator+(size_t offset) const noexcept {
+    VECTOR_CONSTEXPR const T* operator+(size_t offset) const noexcept {
         return const_cast<RawMemory&>(*this) + offset;
     }
 
-    const T& operator[](size_t index) const noexcept {
+    VECTOR_CONSTEXPR const T& operator[](size_t index) const noexcept {
         return const_cast<RawMemory&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
-        assert(index < capacity_);
+    VECTOR_CONSTEXPR T& operator[](size_t index) noexcept {
+        VECTOR_FULL_CHECK(index < capacity_, "index %zu out of buffer capacity %zu", index, capacity_);
         return buffer_[index];
     }
 
-    void Swap(RawMemory& other) noexcept {
+    // Аллокаторы обмениваются, только если этого требует propagate_on_container_swap,
+    // иначе они обязаны быть равны
+    VECTOR_CONSTEXPR void Swap(RawMemory& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        } else {
+            assert(alloc_ == other.alloc_);
+        }
         std::swap(buffer_, other.buffer_);
         std::swap(capacity_, other.capacity_);
     }
 
-    const T* GetAddress() const noexcept {
+    VECTOR_CONSTEXPR const T* GetAddress() const noexcept {
         return buffer_;
     }
 
-    T* GetAddress() noexcept {
+    VECTOR_CONSTEXPR T* GetAddress() noexcept {
         return buffer_;
     }
 
-    size_t Capacity() const {
+    VECTOR_CONSTEXPR size_t Capacity() const {
         return capacity_;
     }
 
+    VECTOR_CONSTEXPR const Allocator& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // Принимает во владение буфер вместимостью capacity элементов, выделенный аллокатором, равным alloc
+    // (например, полученный из Release). Буфер будет освобождён этим аллокатором
+    static RawMemory Adopt(T* buffer, size_t capacity, const Allocator& alloc = Allocator()) noexcept {
+        RawMemory memory(alloc);
+        if (buffer != nullptr) {
+            memory.buffer_ = buffer;
+            memory.capacity_ = capacity;
+            detail::CountAllocation<T>(capacity);
+        }
+        return memory;
+    }
+
+    // Отказывается от владения буфером и возвращает его. Освободить буфер вместимостью Capacity()
+    // (узнать её нужно до вызова) должен вызывающий, аллокатором, равным GetAllocator()
+    T* Release() noexcept {
+        if (buffer_ != nullptr) {
+            detail::CountDeallocation<T>(capacity_);
+        }
+        capacity_ = 0;
+        return std::exchange(buffer_, nullptr);
+    }
+
+    // Изменяет вместимость буфера при помощи метода аллокатора reallocate, который может расширить блок
+    // на месте или перенести его без копирования (mremap). Содержимое переносится побайтово, поэтому
+    // подходит только для тривиально перемещаемых элементов. При исключении буфер не меняется
+    void Reallocate(size_t new_capacity) {
+        static_assert(detail::HasReallocate<Allocator>::value, "Allocator does not provide reallocate");
+        static_assert(is_trivially_relocatable_v<T>);
+        if (buffer_ == nullptr || new_capacity == 0) {
+            RawMemory(new_capacity, alloc_).Swap(*this);
+            return;
+        }
+        buffer_ = alloc_.reallocate(buffer_, capacity_, new_capacity);
+        detail::CountDeallocation<T>(capacity_);
+        detail::CountAllocation<T>(new_capacity);
+        capacity_ = new_capacity;
+    }
+
 private:
-    // Выделяет сырую память под n элементов и возвращает указатель на неё
-    static T* Allocate(size_t n) {
-        return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+    // Выделяет сырую память под n элементов и возвращает указатель на неё.
+    // Выравнивание по alignof(T), в том числе повышенное, обеспечивает аллокатор
+    VECTOR_CONSTEXPR T* Allocate(size_t n) {
+        if (n == 0) {
+            return nullptr;
+        }
+        T* buf = AllocTraits::allocate(alloc_, n);
+        detail::CountAllocation<T>(n);
+        return buf;
     }
 
-    // Освобождает сырую память, выделенную ранее по адресу buf при помощи Allocate
-    static void Deallocate(T* buf) noexcept {
-        operator delete(buf);
+    // Освобождает сырую память под n элементов, выделенную ранее по адресу buf при помощи Allocate
+    VECTOR_CONSTEXPR void Deallocate(T* buf, size_t n) noexcept {
+        if (buf != nullptr) {
+            AllocTraits::deallocate(alloc_, buf, n);
+            detail::CountDeallocation<T>(n);
+        }
     }
 
+    [[no_unique_address]] Allocator alloc_;
     T* buffer_ = nullptr;
     size_t capacity_ = 0;
 };
 
+#ifdef VECTOR_CHECKED_ITERATORS
+// Итератор непрерывного буфера, запоминающий поколение буфера (см. Vector::Generation) в момент создания.
+// Разыменование итератора, пережившего смену буфера, завершает программу с диагностикой. Сравнение,
+// сдвиг и Base() не проверяются, поэтому итератор конца можно передавать в std::to_address.
+// Контейнер должен жить дольше итератора. Вставки и удаления без перевыделения не отслеживаются
 template <typename T>
+class CheckedIterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+#ifdef __cpp_lib_concepts
+    using iterator_concept = std::contiguous_iterator_tag;
+#endif
+    using value_type = std::remove_cv_t<T>;
+    using element_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    CheckedIterator() = default;
+
+    VECTOR_CONSTEXPR CheckedIterator(T* ptr, const detail::BufferGeneration& generation) noexcept
+        : ptr_(ptr)
+        , source_(&generation)
+        , generation_(generation.Value()) {
+    }
+
+    // Неконстантный итератор приводится к константному
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T>>>
+    VECTOR_CONSTEXPR CheckedIterator(const CheckedIterator<U>& other) noexcept
+        : ptr_(other.Base())
+        , source_(other.Source())
+        , generation_(other.Generation()) {
+    }
+
+    VECTOR_CONSTEXPR reference operator*() const noexcept {
+        CheckValid();
+        return *ptr_;
+    }
+    VECTOR_CONSTEXPR pointer operator->() const noexcept {
+        CheckValid();
+        return ptr_;
+    }
+    VECTOR_CONSTEXPR reference operator[](difference_type offset) const noexcept {
+        CheckValid();
+        return ptr_[offset];
+    }
+
+    // Указатель без проверки, например для memcpy
+    VECTOR_CONSTEXPR T* Base() const noexcept {
+        return ptr_;
+    }
+
+    // Истинно, пока буфер, в котором получен итератор, не сменился
+    VECTOR_CONSTEXPR bool IsValid() const noexcept {
+        return source_ != nullptr && source_->Value() == generation_;
+    }
+
+    VECTOR_CONSTEXPR const detail::BufferGeneration* Source() const noexcept {
+        return source_;
+    }
+    VECTOR_CONSTEXPR size_t Generation() const noexcept {
+        return generation_;
+    }
+
+    VECTOR_CONSTEXPR CheckedIterator& operator++() noexcept {
+        ++ptr_;
+        return *this;
+    }
+    VECTOR_CONSTEXPR CheckedIterator operator++(int) noexcept {
+        CheckedIterator result = *this;
+        ++ptr_;
+        return result;
+    }
+    VECTOR_CONSTEXPR CheckedIterator& operator--() noexcept {
+        --ptr_;
+        return *this;
+    }
+    VECTOR_CONSTEXPR CheckedIterator operator--(int) noexcept {
+        CheckedIterator result = *this;
+        --ptr_;
+        return result;
+    }
+    VECTOR_CONSTEXPR CheckedIterator& operator+=(difference_type offset) noexcept {
+        ptr_ += offset;
+        return *this;
+    }
+    VECTOR_CONSTEXPR CheckedIterator& operator-=(difference_type offset) noexcept {
+        ptr_ -= offset;
+        return *this;
+    }
+    friend VECTOR_CONSTEXPR CheckedIterator operator+(CheckedIterator it, difference_type offset) noexcept {
+        return it += offset;
+    }
+    friend VECTOR_CONSTEXPR CheckedIterator operator+(difference_type offset, CheckedIterator it) noexcept {
+        return it += offset;
+    }
+    friend VECTOR_CONSTEXPR CheckedIterator operator-(CheckedIterator it, difference_type offset) noexcept {
+        return it -= offset;
+    }
+
+private:
+    VECTOR_CONSTEXPR void CheckValid() const noexcept {
+        VECTOR_CHECK_IMPL(IsValid(), "iterator of generation %zu used after its vector changed buffer (generation %zu)",
+                          generation_, source_ != nullptr ? source_->Value() : 0);
+    }
+
+    T* ptr_ = nullptr;
+    const detail::BufferGeneration* source_ = nullptr;
+    size_t generation_ = 0;
+};
+
+// Сравнения и разность допускают смешивание константных и неконстантных итераторов
+
+template <typename T, typename U>
+VECTOR_CONSTEXPR std::ptrdiff_t operator-(const CheckedIterator<T>& lhs, const CheckedIterator<U>& rhs) noexcept {
+    return lhs.Base() - rhs.Base();
+}
+template <typename T, typename U>
+VECTOR_CONSTEXPR bool operator==(const CheckedIterator<T>& lhs, const CheckedIterator<U>& rhs) noexcept {
+    return lhs.Base() == rhs.Base();
+}
+template <typename T, typename U>
+VECTOR_CONSTEXPR bool operator!=(const CheckedIterator<T>& lhs, const CheckedIterator<U>& rhs) noexcept {
+    return lhs.Base() != rhs.Base();
+}
+template <typename T, typename U>
+VECTOR_CONSTEXPR bool operator<(const CheckedIterator<T>& lhs, const CheckedIterator<U>& rhs) noexcept {
+    return lhs.Base() < rhs.Base();
+}
+template <typename T, typename U>
+VECTOR_CONSTEXPR bool operator>(const CheckedIterator<T>& lhs, const CheckedIterator<U>& rhs) noexcept {
+    return lhs.Base() > rhs.Base();
+}
+template <typename T, typename U>
+VECTOR_CONSTEXPR bool operator<=(const CheckedIterator<T>& lhs, const CheckedIterator<U>& rhs) noexcept {
+    return lhs.Base() <= rhs.Base();
+}
+template <typename T, typename U>
+VECTOR_CONSTEXPR bool operator>=(const CheckedIterator<T>& lhs, const CheckedIterator<U>& rhs) noexcept {
+    return lhs.Base() >= rhs.Base();
+}
+#endif
+
+// Если аллокатор умеет изменять размер блока (метод reallocate, см. HugePageAllocator), вектор тривиально
+// перемещаемых элементов растёт и уменьшается через него, не выделяя второй буфер на время переноса
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth>
 class Vector {
+    using AllocTraits = std::allocator_traits<Allocator>;
+    static constexpr bool REALLOCATE_IN_PLACE =
+        is_trivially_relocatable_v<T> && detail::HasReallocate<Allocator>::value;
+
 public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
     Vector() = default;
 
-    explicit Vector(size_t size)
-        : data_(size)
+    VECTOR_CONSTEXPR explicit Vector(const Allocator& alloc) noexcept
+        : data_(alloc) {
+    }
+
+    VECTOR_CONSTEXPR explicit Vector(size_t size, const Allocator& alloc = Allocator())
+        : data_(size, alloc)
         , size_(size)
     {
-        std::uninitialized_value_construct_n(data_.GetAddress(), size_);
+        detail::UninitializedValueConstructN(data_.GetAddress(), size_);
+    }
+
+    VECTOR_CONSTEXPR Vector(const Vector& other)
+        : Vector(other, AllocTraits::select_on_container_copy_construction(other.GetAllocator())) {
     }
 
-    Vector(const Vector& other)
-        : data_(other.size_)
+    VECTOR_CONSTEXPR Vector(const Vector& other, const Allocator& alloc)
+        : data_(other.size_, alloc)
         , size_(other.size_)
     {
-        std::uninitialized_copy_n(other.data_.GetAddress(), size_, data_.GetAddress());
+        detail::UninitializedCopyN(other.data_.GetAddress(), size_, data_.GetAddress());
+    }
+
+    // Создаёт size элементов, инициализированных значением по умолчанию, параллельно (см. ParallelPolicy)
+    Vector(const ParallelPolicy& policy, size_t size, const Allocator& alloc = Allocator())
+        : data_(size, alloc)
+    {
+        T* const dst = data_.GetAddress();
+        detail::ParallelConstructN(dst, size, policy, [dst](size_t first, size_t count) {
+            std::uninitialized_value_construct_n(dst + first, count);
+        });
+        size_ = size;
     }
 
-    Vector(Vector&& other) noexcept {
-        Swap(other);
+    // Параллельно копирует элементы other (см. ParallelPolicy)
+    Vector(const ParallelPolicy& policy, const Vector& other)
+        : data_(other.size_, AllocTraits::select_on_container_copy_construction(other.GetAllocator()))
+    {
+        T* const dst = data_.GetAddress();
+        const T* const src = other.data_.GetAddress();
+        detail::ParallelConstructN(dst, other.size_, policy, [dst, src](size_t first, size_t count) {
+            std::uninitialized_copy_n(src + first, count, dst + first);
+        });
+        size_ = other.size_;
+    }
+
+    VECTOR_CONSTEXPR Vector(Vector&& other) noexcept
+        : data_(std::move(other.data_))
+        , size_(std::exchange(other.size_, 0)) {
+    }
+
+    // Принимает во владение буфер data, первые size элементов которого уже созданы
+    VECTOR_CONSTEXPR Vector(RawMemory<T, Allocator>&& data, size_t size) noexcept
+        : data_(std::move(data))
+        , size_(size) {
+        VECTOR_CHECK(size <= data_.Capacity(), "size %zu exceeds buffer capacity %zu", size, data_.Capacity());
     }
 
-    ~Vector() {
+    VECTOR_CONSTEXPR ~Vector() {
+        detail::CountRelease<T>(Capacity(), size_);
         std::destroy_n(data_.GetAddress(), size_);
     }
 
+    // Без VECTOR_CHECKED_ITERATORS итераторы — обычные указатели
+#ifdef VECTOR_CHECKED_ITERATORS
+    using iterator = CheckedIterator<T>;
+    using const_iterator = CheckedIterator<const T>;
+#else
     using iterator = T*;
     using const_iterator = const T*;
-    
-    iterator begin() noexcept {
-        return data_.GetAddress();
+#endif
+
+    VECTOR_CONSTEXPR iterator begin() noexcept {
+        return MakeIterator(data_.GetAddress());
     }
-    iterator end() noexcept {
-        return data_.GetAddress() + size_;
+    VECTOR_CONSTEXPR iterator end() noexcept {
+        return MakeIterator(data_.GetAddress() + size_);
     }
-    const_iterator begin() const noexcept {
-        return data_.GetAddress();
+    VECTOR_CONSTEXPR const_iterator begin() const noexcept {
+        return const_cast<Vector&>(*this).begin();
     }
-    const_iterator end() const noexcept {
-        return data_.GetAddress() + size_;
+    VECTOR_CONSTEXPR const_iterator end() const noexcept {
+        return const_cast<Vector&>(*this).end();
     }
-    const_iterator cbegin() const noexcept {
+    VECTOR_CONSTEXPR const_iterator cbegin() const noexcept {
         return begin();
     }
-    const_iterator cend() const noexcept {
+    VECTOR_CONSTEXPR const_iterator cend() const noexcept {
         return end();
     }
 
-    Vector& operator=(const Vector& rhs) {
+    // Указатель на первый элемент; в отличие от итераторов всегда обычный указатель
+    VECTOR_CONSTEXPR T* Data() noexcept {
+        return data_.GetAddress();
+    }
+    VECTOR_CONSTEXPR const T* Data() const noexcept {
+        return data_.GetAddress();
+    }
+
+    VECTOR_CONSTEXPR Vector& operator=(const Vector& rhs) {
         if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                if (GetAllocator() != rhs.GetAllocator()) {
+                    // текущий буфер нельзя переиспользовать: он принадлежит старому аллокатору
+                    Vector rhs_copy(rhs, rhs.GetAllocator());
+                    TakeBuffer(rhs_copy);
+                    return *this;
+                }
+            }
             if (rhs.size_ > data_.Capacity()) {
                 // copy-and-swap
-                Vector rhs_copy(rhs);
+                Vector rhs_copy(rhs, GetAllocator());
                 Swap(rhs_copy);
+                generation_.Bump();
             } else {
-                // копируем из rhs, создав при необходимости новые, или удалив существующие
-                if (rhs.size_ < size_) {
-                    std::copy(rhs.data_.GetAddress(), rhs.data_.GetAddress() + rhs.size_, data_.GetAddress());
-                    std::destroy_n(data_.GetAddress() + rhs.size_, size_ - rhs.size_);
-                } else {
-                    std::copy(rhs.data_.GetAddress(), rhs.data_.GetAddress() + size_, data_.GetAddress());
-                    std::uninitialized_copy_n(rhs.data_.GetAddress() + size_, rhs.size_ - size_, data_.GetAddress() + size_);
-                }
-                size_ = rhs.size_;
+                detail::AssignInPlace(data_.GetAddress(), size_, rhs.data_.GetAddress(), rhs.size_);
             }
         }
         return *this;
     }
-    
-    Vector& operator=(Vector&& rhs) noexcept {
+
+    VECTOR_CONSTEXPR Vector& operator=(Vector&& rhs) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                             || AllocTraits::is_always_equal::value) {
         if (this != &rhs) {
-            Swap(rhs);
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+                TakeBuffer(rhs);
+            } else {
+                if (GetAllocator() == rhs.GetAllocator()) {
+                    Swap(rhs);
+                    generation_.Bump();
+                } else {
+                    // память rhs нельзя освободить нашим аллокатором, поэтому перемещаем поэлементно
+                    if (rhs.size_ > data_.Capacity()) {
+                        Vector rhs_copy(GetAllocator());
+                        rhs_copy.Reserve(rhs.size_);
+                        detail::UninitializedMoveN(rhs.data_.GetAddress(), rhs.size_, rhs_copy.data_.GetAddress());
+                        rhs_copy.size_ = rhs.size_;
+                        Swap(rhs_copy);
+                        generation_.Bump();
+                    } else {
+                        detail::AssignInPlace(data_.GetAddress(), size_,
+                                              std::make_move_iterator(rhs.data_.GetAddress()), rhs.size_);
+                    }
+                }
+            }
         }
         return *this;
     }
 
-    const T& operator[](size_t index) const noexcept {
+    VECTOR_CONSTEXPR const T& operator[](size_t index) const noexcept {
         return const_cast<Vector&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
-        assert(index < size_);
+    VECTOR_CONSTEXPR T& operator[](size_t index) noexcept {
+        VECTOR_CHECK(index < size_, "index %zu out of range for size %zu", index, size_);
         return data_[index];
     }
 
-    void Swap(Vector& other) noexcept {
+    VECTOR_CONSTEXPR void Swap(Vector& other) noexcept {
         data_.Swap(other.data_);
         std::swap(size_, other.size_);
     }
 
-    size_t Size() const noexcept {
+    VECTOR_CONSTEXPR size_t Size() const noexcept {
         return size_;
     }
 
-    size_t Capacity() const noexcept {
+    VECTOR_CONSTEXPR size_t Capacity() const noexcept {
         return data_.Capacity();
     }
 
-    void Reserve(size_t new_capacity) {
+    // Номер поколения буфера: увеличивается при каждой смене буфера (перевыделении, освобождении,
+    // присваивании). Итераторы и указатели, полученные в другом поколении, недействительны.
+    // Ведётся только при VECTOR_CHECK_LEVEL >= 2 или VECTOR_CHECKED_ITERATORS, иначе всегда 0
+    VECTOR_CONSTEXPR size_t Generation() const noexcept {
+        return generation_.Value();
+    }
+
+    // Максимальное число элементов, которое может вместить вектор
+    VECTOR_CONSTEXPR size_t MaxSize() const noexcept {
+        return std::min<size_t>(AllocTraits::max_size(GetAllocator()),
+                                std::numeric_limits<std::ptrdiff_t>::max() / sizeof(T));
+    }
+
+    VECTOR_CONSTEXPR const Allocator& GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+    VECTOR_CONSTEXPR void Reserve(size_t new_capacity) {
         if (new_capacity <= data_.Capacity()) {
             return;
         }
+        if (new_capacity > MaxSize()) {
+            throw std::length_error("Vector capacity overflow");
+        }
+        ReallocateTo(new_capacity);
+    }
 
-        RawMemory<T> new_data(new_capacity);
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
-        } else {
-            std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
+    // Уменьшает вместимость до размера. Элементы переносятся так же, как в Reserve,
+    // поэтому при исключении вектор не меняется
+    VECTOR_CONSTEXPR void ShrinkToFit() {
+        if (Capacity() != size_) {
+            ReallocateTo(size_);
         }
+    }
 
+    // Удаляет все элементы, сохраняя вместимость
+    VECTOR_CONSTEXPR void Clear() noexcept {
         std::destroy_n(data_.GetAddress(), size_);
-        data_.Swap(new_data);
+        size_ = 0;
+    }
+
+    // Отдаёт буфер вместе с элементами и их количеством, оставляя вектор пустым.
+    // Разрушить элементы должен новый владелец буфера
+    VECTOR_CONSTEXPR std::pair<RawMemory<T, Allocator>, size_t> ReleaseBuffer() noexcept {
+        RawMemory<T, Allocator> data(GetAllocator());
+        data.Swap(data_);
+        generation_.Bump();
+        return {std::move(data), std::exchange(size_, 0)};
     }
 
-    void Resize(size_t new_size) {
+    // Удаляет все элементы и освобождает буфер
+    VECTOR_CONSTEXPR void ClearAndRelease() noexcept {
+        Clear();
+        RawMemory<T, Allocator>(GetAllocator()).Swap(data_);
+        generation_.Bump();
+    }
+
+    // При увеличении размера вместимость растёт согласно политике роста, поэтому
+    // последовательность вызовов Resize(Size() + k) выполняется за амортизированное O(k)
+    VECTOR_CONSTEXPR void Resize(size_t new_size) {
         if (new_size <= size_) {
-            std::destroy_n(data_.GetAddress() + new_size, size_ - new_size);
-        } else {
-            Reserve(new_size);
-            std::uninitialized_value_construct_n(data_.GetAddress() + size_, new_size - size_);
+            Truncate(new_size);
+            return;
         }
+        ReserveForGrowth(new_size);
+        detail::UninitializedValueConstructN(data_.GetAddress() + size_, new_size - size_);
         size_ = new_size;
     }
 
-    void PopBack() {
+    // Новые элементы создаются копированием value, который может быть элементом этого же вектора
+    VECTOR_CONSTEXPR void Resize(size_t new_size, const T& value) {
+        GrowFilled(new_size, [&value](T* dst, size_t count) {
+            detail::UninitializedFillN(dst, count, value);
+        });
+    }
+
+    // То же, что Resize(new_size), но новые элементы создаются параллельно (см. ParallelPolicy)
+    void Resize(const ParallelPolicy& policy, size_t new_size) {
+        if (new_size <= size_) {
+            Truncate(new_size);
+            return;
+        }
+        ReserveForGrowth(new_size);
+        T* const dst = data_.GetAddress() + size_;
+        detail::ParallelConstructN(dst, new_size - size_, policy, [dst](size_t first, size_t count) {
+            std::uninitialized_value_construct_n(dst + first, count);
+        });
+        size_ = new_size;
+    }
+
+    // То же, что Resize(new_size, value), но новые элементы создаются параллельно (см. ParallelPolicy)
+    void Resize(const ParallelPolicy& policy, size_t new_size, const T& value) {
+        GrowFilled(new_size, [&policy, &value](T* dst, size_t count) {
+            detail::ParallelConstructN(dst, count, policy, [dst, &value](size_t first, size_t n) {
+                std::uninitialized_fill_n(dst + first, n, value);
+            });
+        });
+    }
+
+    // В отличие от Resize, новые элементы инициализируются по умолчанию: для тривиальных типов
+    // их значения не определены. Подходит для буферов, которые сразу будут перезаписаны
+    void ResizeDefaultInit(size_t new_size) {
+        if (new_size <= size_) {
+            Truncate(new_size);
+            return;
+        }
+        ReserveForGrowth(new_size);
+        std::uninitialized_default_construct_n(data_.GetAddress() + size_, new_size - size_);
+        size_ = new_size;
+    }
+
+    // Обеспечивает место под count элементов за концом вектора (расширяя буфер по политике роста)
+    // и возвращает указатель на эту неинициализированную память. Записанные туда байты становятся
+    // элементами после CommitAppend; до него размер не меняется. Только для тривиально копируемых T,
+    // например чтобы читать записи из файла прямо в буфер
+    T* PrepareAppend(size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>, "PrepareAppend fills elements as raw bytes");
+        if (count > MaxSize() - size_) {
+            throw std::length_error("Vector capacity overflow");
+        }
+        ReserveForGrowth(size_ + count);
+        return data_.GetAddress() + size_;
+    }
+
+    // Добавляет к вектору count элементов, записанных в память, полученную из PrepareAppend
+    void CommitAppend(size_t count) noexcept {
+        static_assert(std::is_trivially_copyable_v<T>, "PrepareAppend fills elements as raw bytes");
+        VECTOR_CHECK(count <= Capacity() - size_, "committing %zu elements with %zu prepared", count,
+                     Capacity() - size_);
+        size_ += count;
+    }
+
+    VECTOR_CONSTEXPR void PopBack() {
         if (size_ > 0) {
             --size_;
             std::destroy_at(data_.GetAddress() + size_);
+            MaybeShrink();
         }
     }
 
-    // реализация EmplaceBack на основе Emplace
-    // при добавлении этого метода не проходит тесты в тренажере (Вы неверно реализовали метод EmplaceBack)
-    // прошу сообщить в чем ошибка, или тесты на это не расчитаны? 
+    // Быстрый путь дозаписи проверяет только вместимость; перевыделение вынесено в EmplaceWithReallocation.
+    // args могут ссылаться на элементы вектора
     template <typename... Args>
-    T& EmplaceBack(Args&&... args) {
-        T* value = Emplace(end(), std::forward<Args>(args)...);
+    VECTOR_CONSTEXPR T& EmplaceBack(Args&&... args) {
+        if (VECTOR_LIKELY(size_ != Capacity())) {
+            return UncheckedEmplaceBack(std::forward<Args>(args)...);
+        }
+        return *EmplaceWithReallocation(size_, std::forward<Args>(args)...);
+    }
+
+    // Дозапись в вектор, для которой место уже зарезервировано (Size() < Capacity()).
+    // Буфер не расширяется; нехватка места обнаруживается только проверкой VECTOR_CHECK
+    template <typename... Args>
+    VECTOR_CONSTEXPR T& UncheckedEmplaceBack(Args&&... args) {
+        VECTOR_CHECK(size_ < Capacity(), "unchecked append to a full vector of capacity %zu", Capacity());
+        T* const value = detail::ConstructAt(data_.GetAddress() + size_, std::forward<Args>(args)...);
+        ++size_;
         return *value;
     }
 
+    class BatchAppender;
+
+    // Начинает пакетную дозапись, резервируя место под block элементов (см. BatchAppender)
+    VECTOR_CONSTEXPR BatchAppender BatchAppend(size_t block = 0) {
+        return BatchAppender(*this, block);
+    }
+
     template <typename Type>
-    void PushBack(Type&& value) {
+    VECTOR_CONSTEXPR void PushBack(Type&& value) {
         EmplaceBack(std::forward<Type>(value));
     }
 
     // реализация PushBack c константной ссылкой, пробовал по разному, но 
     // при добавлении этого метода не проходит тесты в тренажере (Вы неверно реализовали метод PushBack)
     // прошу сообщить в чем ошибка, или тесты на это не расчитаны? 
-    void PushBack(const T& value) {
+    VECTOR_CONSTEXPR void PushBack(const T& value) {
         EmplaceBack(value);
     }
 
     template <typename... Args>
-    iterator Emplace(const_iterator pos, Args&& ...args) {
-        assert(pos >= begin() && pos <= end());
-        size_t new_capacity(size_ == 0 ? 1 : size_ * 2);
-        size_t pos_num = pos - begin();
-        iterator value = nullptr;
-
-        if (size_ == Capacity()) {
-            RawMemory<T> new_data(new_capacity);
-            value = new (new_data + pos_num) T(std::forward<Args>(args)...);
-
-            ReAllocate(pos_num, new_data);
+    VECTOR_CONSTEXPR iterator Emplace(const_iterator pos, Args&& ...args) {
+        VECTOR_CHECK(pos >= begin() && pos <= end(), "position %td outside [0, %zu]", pos - cbegin(), size_);
+        const size_t pos_num = pos - cbegin();
+        T* value = size_ == Capacity()
+            ? EmplaceWithReallocation(pos_num, std::forward<Args>(args)...)
+            : detail::EmplaceInPlace(data_.GetAddress(), size_, pos_num, std::forward<Args>(args)...);
+        return MakeIterator(value);
+    }
 
-            std::destroy_n(begin(), size_);
-            data_.Swap(new_data);
+    VECTOR_CONSTEXPR iterator Erase(const_iterator pos) {
+        VECTOR_CHECK(pos >= begin() && pos < end(), "position %td outside [0, %zu)", pos - cbegin(), size_);
+        return Erase(pos, pos + 1);
+    }
 
-        } else {
-            if (size_ != 0) {
-                new (data_ + size_) T(std::forward<T>(*(end() - 1)));
-                try {
-                    std::move_backward(begin() + pos_num, end(), end() + 1);
-                }
-                catch (...) {
-                    std::destroy_at(end());
-                    throw;
-                }
-                std::destroy_at(begin() + pos_num);
-            }
-            value = new (data_ + pos_num) T(std::forward<Args>(args)...);
+    // Удаляет элементы [first, last), сдвигая хвост один раз
+    VECTOR_CONSTEXPR iterator Erase(const_iterator first, const_iterator last) {
+        VECTOR_CHECK(first >= begin() && first <= last && last <= end(), "range [%td, %td) outside [0, %zu]",
+                     first - cbegin(), last - cbegin(), size_);
+        const size_t pos_num = first - cbegin();
+        if (first != last) {
+            detail::EraseInPlace(data_.GetAddress(), size_, pos_num, last - first);
+            MaybeShrink();
         }
-        ++size_;
-        
-        return value;
+        return begin() + pos_num;
     }
 
-    iterator Erase(const_iterator pos) {
-        assert(pos >= begin() && pos < end());
-        size_t pos_num = pos - begin();
-        std::move(begin() + pos_num + 1, end(), begin() + pos_num);
-        PopBack();
+    // Удаляет элемент pos за O(1), перемещая на его место последний элемент.
+    // Порядок остальных элементов не сохраняется
+    VECTOR_CONSTEXPR iterator UnorderedErase(const_iterator pos) {
+        VECTOR_CHECK(pos >= begin() && pos < end(), "position %td outside [0, %zu)", pos - cbegin(), size_);
+        const size_t pos_num = pos - cbegin();
+        detail::UnorderedEraseInPlace(data_.GetAddress(), size_, pos_num);
+        MaybeShrink();
         return begin() + pos_num;
     }
 
-    iterator Insert(const_iterator pos, T&& value) {
+    VECTOR_CONSTEXPR iterator Insert(const_iterator pos, T&& value) {
         return Emplace(pos, std::move(value));
     }
 
     // реализация для ссылки
-    iterator Insert(const_iterator pos, const T& value) {
+    VECTOR_CONSTEXPR iterator Insert(const_iterator pos, const T& value) {
         return Emplace(pos, value);
     }
 
-private:
-    void ReAllocate(size_t pos_num, RawMemory<T>& new_data) {
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-                std::uninitialized_move_n(begin(), pos_num, new_data.GetAddress());
-                std::uninitialized_move_n(begin() + pos_num, size_ - pos_num, new_data.GetAddress() + pos_num + 1);
+    // Вставляет элементы диапазона [first, last) перед pos. Для forward-итераторов буфер
+    // перевыделяется не более одного раза, а хвост вектора сдвигается ровно один раз.
+    // Диапазон не должен указывать на элементы этого же вектора
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    VECTOR_CONSTEXPR iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+        VECTOR_CHECK(pos >= begin() && pos <= end(), "position %td outside [0, %zu]", pos - cbegin(), size_);
+        const size_t pos_num = pos - cbegin();
+        if constexpr (detail::is_forward_iterator_v<InputIt>) {
+            return InsertN(pos_num, first, static_cast<size_t>(std::distance(first, last)));
+        } else {
+            // длина диапазона заранее неизвестна: добавляем в конец и переставляем на место
+            const size_t old_size = size_;
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+            std::rotate(begin() + pos_num, begin() + old_size, end());
+            return begin() + pos_num;
+        }
+    }
+
+    // Вставляет count копий value перед pos. value может быть элементом этого же вектора
+    VECTOR_CONSTEXPR iterator Insert(const_iterator pos, size_t count, const T& value) {
+        VECTOR_CHECK(pos >= begin() && pos <= end(), "position %td outside [0, %zu]", pos - cbegin(), size_);
+        const size_t pos_num = pos - cbegin();
+        if (count <= Capacity() - size_) {
+            // сдвиг хвоста может затронуть value, поэтому вставляем его копию
+            const T value_copy(value);
+            return InsertN(pos_num, detail::RepeatIterator<T>(value_copy, 0), count);
+        }
+        return InsertN(pos_num, detail::RepeatIterator<T>(value, 0), count);
+    }
+
+    VECTOR_CONSTEXPR iterator Insert(const_iterator pos, std::initializer_list<T> values) {
+        return Insert(pos, values.begin(), values.end());
+    }
+
+    // Добавляет элементы диапазона [first, last) в конец вектора
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    VECTOR_CONSTEXPR void Append(InputIt first, InputIt last) {
+        Insert(end(), first, last);
+    }
+
+    // Заменяет содержимое вектора элементами диапазона [first, last). Для forward-итераторов
+    // буфер перевыделяется не более одного раза, и только если диапазон в него не помещается
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    VECTOR_CONSTEXPR void Assign(InputIt first, InputIt last) {
+        if constexpr (detail::is_forward_iterator_v<InputIt>) {
+            const size_t count = static_cast<size_t>(std::distance(first, last));
+            if (count > Capacity()) {
+                if (count > MaxSize()) {
+                    throw std::length_error("Vector capacity overflow");
+                }
+                RawMemory<T, Allocator> new_data(count, GetAllocator());
+                detail::UninitializedCopyN(first, count, new_data.GetAddress());
+                std::destroy_n(data_.GetAddress(), size_);
+                data_.Swap(new_data);
+                generation_.Bump();
+                size_ = count;
             } else {
+                detail::AssignInPlace(data_.GetAddress(), size_, first, count);
+            }
+        } else {
+            detail::AssignFromInput(data_.GetAddress(), size_, first, last, [this](const auto& value) {
+                EmplaceBack(value);
+            });
+        }
+    }
+
+private:
+    VECTOR_CONSTEXPR iterator MakeIterator(T* ptr) noexcept {
+#ifdef VECTOR_CHECKED_ITERATORS
+        return iterator(ptr, generation_);
+#else
+        return ptr;
+#endif
+    }
+
+    // Вместимость, до которой следует расширить буфер, чтобы в нём поместилось required элементов
+    VECTOR_CONSTEXPR size_t GrowthCapacity(size_t required) const {
+        return GrowthPolicy::NextCapacity(Capacity(), required, sizeof(T), MaxSize());
+    }
+
+    // Переносит элементы в новый буфер вместимостью new_capacity (не меньше размера)
+    VECTOR_CONSTEXPR void ReallocateTo(size_t new_capacity) {
+        assert(new_capacity >= size_);
+        if constexpr (REALLOCATE_IN_PLACE) {
+            data_.Reallocate(new_capacity);
+            // элементы переносит аллокатор, но для статистики это такое же перевыделение
+            detail::CountRelocation<T>(size_);
+            generation_.Bump();
+            return;
+        }
+        RawMemory<T, Allocator> new_data(new_capacity, GetAllocator());
+        detail::UninitializedRelocateN(data_.GetAddress(), size_, new_data.GetAddress());
+        data_.Swap(new_data);
+        generation_.Bump();
+    }
+
+    // Вставка в заполненный буфер: элемент из args конструируется в позиции pos_num нового буфера.
+    // Вынесена из Emplace и EmplaceBack и не встраивается, чтобы путь без перевыделения оставался коротким
+    template <typename... Args>
+    VECTOR_NOINLINE VECTOR_CONSTEXPR T* EmplaceWithReallocation(size_t pos_num, Args&&... args) {
+        T* value = nullptr;
+        if constexpr (REALLOCATE_IN_PLACE) {
+            // args могут ссылаться на элементы вектора, поэтому элемент создаётся до изменения буфера
+            alignas(T) unsigned char storage[sizeof(T)];
+            T* new_value = new (storage) T(std::forward<Args>(args)...);
+            try {
+                data_.Reallocate(GrowthCapacity(size_ + 1));
+                detail::CountRelocation<T>(size_);
+                generation_.Bump();
+            }
+            catch (...) {
+                std::destroy_at(new_value);
+                throw;
+            }
+            value = data_.GetAddress() + pos_num;
+            detail::RelocateBytesOverlapping(value, size_ - pos_num, value + 1);
+            detail::RelocateBytes(new_value, 1, value);
+        } else {
+            RawMemory<T, Allocator> new_data(GrowthCapacity(size_ + 1), GetAllocator());
+            value = detail::ConstructAt(new_data + pos_num, std::forward<Args>(args)...);
+
+            detail::UninitializedRelocateWithGap(data_.GetAddress(), size_, pos_num, 1, new_data.GetAddress());
+            data_.Swap(new_data);
+            generation_.Bump();
+        }
+        ++size_;
+        return value;
+    }
+
+    // Изменяет размер до new_size, создавая новые элементы вызовом fill(dst, count) для
+    // неинициализированной памяти. fill может читать элементы вектора: при перевыделении
+    // новый буфер заполняется до переноса старых элементов
+    template <typename Fill>
+    VECTOR_CONSTEXPR void GrowFilled(size_t new_size, Fill fill) {
+        if (new_size <= size_) {
+            Truncate(new_size);
+            return;
+        }
+        if (new_size <= Capacity()) {
+            fill(data_.GetAddress() + size_, new_size - size_);
+        } else {
+            RawMemory<T, Allocator> new_data(GrowthCapacity(new_size), GetAllocator());
+            fill(new_data.GetAddress() + size_, new_size - size_);
+            try {
+                detail::UninitializedRelocateN(data_.GetAddress(), size_, new_data.GetAddress());
+            }
+            catch (...) {
+                std::destroy_n(new_data.GetAddress() + size_, new_size - size_);
+                throw;
+            }
+            data_.Swap(new_data);
+            generation_.Bump();
+        }
+        size_ = new_size;
+    }
+
+    // Удаляет элементы начиная с new_size (new_size <= Size())
+    VECTOR_CONSTEXPR void Truncate(size_t new_size) noexcept {
+        std::destroy_n(data_.GetAddress() + new_size, size_ - new_size);
+        size_ = new_size;
+        MaybeShrink();
+    }
+
+    // Уменьшает вместимость, если этого требует политика роста. Уменьшение необязательно,
+    // поэтому неудачное перевыделение (нехватка памяти, исключение при копировании) игнорируется
+    VECTOR_CONSTEXPR void MaybeShrink() noexcept {
+        if constexpr (GrowthPolicy::AUTO_SHRINK) {
+            const size_t new_capacity = GrowthPolicy::ShrinkCapacity(size_, Capacity());
+            if (new_capacity < Capacity()) {
                 try {
-                    std::uninitialized_copy_n(begin(), pos_num, new_data.GetAddress());
-                    std::uninitialized_copy_n(begin() + pos_num, size_ - pos_num, new_data.GetAddress() + pos_num + 1);
+                    ReallocateTo(new_capacity);
                 }
                 catch (...) {
-                    std::destroy_at(new_data.GetAddress() + pos_num);
-                    throw;
                 }
             }
+        }
+    }
+
+    // Расширяет буфер согласно политике роста, если в нём не помещается required элементов
+    VECTOR_CONSTEXPR void ReserveForGrowth(size_t required) {
+        if (required > Capacity()) {
+            Reserve(GrowthCapacity(required));
+        }
+    }
+
+    // Вставляет count элементов, перечисляемых forward-итератором first, в позицию pos_num
+    template <typename ForwardIt>
+    VECTOR_CONSTEXPR iterator InsertN(size_t pos_num, ForwardIt first, size_t count) {
+        if (count == 0) {
+            return begin() + pos_num;
+        }
+        if (count <= Capacity() - size_) {
+            return MakeIterator(detail::InsertInPlace(data_.GetAddress(), size_, pos_num, first, count));
+        }
+        if (count > MaxSize() - size_) {
+            throw std::length_error("Vector capacity overflow");
+        }
+        // новые элементы создаются до переноса старых, поэтому при исключении вектор не меняется
+        RawMemory<T, Allocator> new_data(GrowthCapacity(size_ + count), GetAllocator());
+        detail::UninitializedCopyN(first, count, new_data.GetAddress() + pos_num);
+        detail::UninitializedRelocateWithGap(data_.GetAddress(), size_, pos_num, count, new_data.GetAddress());
+        data_.Swap(new_data);
+        generation_.Bump();
+        size_ += count;
+        return begin() + pos_num;
+    }
+
+    // Разрушает свои элементы и забирает буфер other вместе с его аллокатором
+    VECTOR_CONSTEXPR void TakeBuffer(Vector& other) noexcept {
+        std::destroy_n(data_.GetAddress(), size_);
+        data_ = std::move(other.data_);
+        generation_.Bump();
+        size_ = std::exchange(other.size_, 0);
     }
 
 private:
-    RawMemory<T> data_;
+    RawMemory<T, Allocator> data_;
     size_t size_ = 0;
-};
\ No newline at end of file
+    [[no_unique_address]] detail::BufferGeneration generation_;
+};
+
+// Пакетная дозапись в конец вектора. Элементы конструируются подряд за концом вектора, а его размер
+// обновляется один раз — в Commit или деструкторе, поэтому в цикле дозаписи остаются только сравнение
+// с границей зарезервированного места, конструирование и сдвиг указателя. Когда место кончается,
+// буфер расширяется по политике роста, но не меньше чем на block элементов.
+// Пока дозаписчик жив, вектор используют только через него: Size() и итераторы вектора не видят
+// незафиксированных элементов, а аргументы EmplaceBack не должны ссылаться на элементы вектора.
+// При исключении уже добавленные элементы остаются в векторе
+template <typename T, typename Allocator, typename GrowthPolicy>
+class Vector<T, Allocator, GrowthPolicy>::BatchAppender {
+public:
+    // Итератор вывода, добавляющий присваиваемые значения, как std::back_inserter
+    class Inserter {
+    public:
+        using iterator_category = std::output_iterator_tag;
+        using value_type = void;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = void;
+
+        VECTOR_CONSTEXPR explicit Inserter(BatchAppender& appender) noexcept
+            : appender_(&appender) {
+        }
+
+        VECTOR_CONSTEXPR Inserter& operator=(const T& value) {
+            appender_->EmplaceBack(value);
+            return *this;
+        }
+        VECTOR_CONSTEXPR Inserter& operator=(T&& value) {
+            appender_->EmplaceBack(std::move(value));
+            return *this;
+        }
+        VECTOR_CONSTEXPR Inserter& operator*() noexcept {
+            return *this;
+        }
+        VECTOR_CONSTEXPR Inserter& operator++() noexcept {
+            return *this;
+        }
+        VECTOR_CONSTEXPR Inserter operator++(int) noexcept {
+            return *this;
+        }
+
+    private:
+        BatchAppender* appender_;
+    };
+
+    VECTOR_CONSTEXPR BatchAppender(Vector& vector, size_t block)
+        : vector_(vector)
+        , block_(std::max<size_t>(block, 1)) {
+        if (block != 0) {
+            ReserveAhead();
+        }
+        Reset();
+    }
+
+    BatchAppender(const BatchAppender&) = delete;
+    BatchAppender& operator=(const BatchAppender&) = delete;
+
+    VECTOR_CONSTEXPR ~BatchAppender() {
+        Commit();
+    }
+
+    template <typename... Args>
+    VECTOR_CONSTEXPR T& EmplaceBack(Args&&... args) {
+        if (VECTOR_UNLIKELY(cursor_ == limit_)) {
+            Grow();
+        }
+        T* const value = detail::ConstructAt(cursor_, std::forward<Args>(args)...);
+        ++cursor_;
+        return *value;
+    }
+
+    VECTOR_CONSTEXPR void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    VECTOR_CONSTEXPR void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    VECTOR_CONSTEXPR Inserter BackInserter() noexcept {
+        return Inserter(*this);
+    }
+
+    // Размер вектора вместе с незафиксированными элементами
+    VECTOR_CONSTEXPR size_t Size() const noexcept {
+        return cursor_ - vector_.data_.GetAddress();
+    }
+
+    // Делает добавленные элементы видимыми через вектор. Дозапись можно продолжать
+    VECTOR_CONSTEXPR void Commit() noexcept {
+        vector_.size_ = Size();
+    }
+
+private:
+    // Расширение буфера — редкая ветка, поэтому вынесено из EmplaceBack
+    VECTOR_NOINLINE VECTOR_CONSTEXPR void Grow() {
+        Commit();
+        ReserveAhead();
+        Reset();
+    }
+
+    // Обеспечивает место ещё под block_ элементов (или сколько допускает MaxSize, но хотя бы под один)
+    VECTOR_CONSTEXPR void ReserveAhead() {
+        const size_t room = vector_.MaxSize() - vector_.size_;
+        vector_.ReserveForGrowth(vector_.size_ + (block_ <= room ? block_ : std::max<size_t>(room, 1)));
+    }
+
+    VECTOR_CONSTEXPR void Reset() noexcept {
+        cursor_ = vector_.data_.GetAddress() + vector_.size_;
+        limit_ = vector_.data_.GetAddress() + vector_.Capacity();
+    }
+
+    Vector& vector_;
+    size_t block_;
+    T* cursor_ = nullptr;
+    T* limit_ = nullptr;
+};
+
+// Удаляет из вектора все элементы, удовлетворяющие предикату, за один проход.
+// Возвращает количество удалённых элементов
+template <typename T, typename Allocator, typename GrowthPolicy, typename Predicate>
+VECTOR_CONSTEXPR size_t EraseIf(Vector<T, Allocator, GrowthPolicy>& v, Predicate pred) {
+    const auto new_end = std::remove_if(v.begin(), v.end(), pred);
+    const size_t removed = v.end() - new_end;
+    v.Erase(new_end, v.end());
+    return removed;
+}
+
+#if VECTOR_HAS_CONSTEXPR
+namespace detail {
+
+template <auto Build, size_t... Indexes>
+constexpr auto FreezeVector(std::index_sequence<Indexes...>) {
+    const auto elements = Build();
+    return std::array<typename decltype(elements)::value_type, sizeof...(Indexes)>{elements[Indexes]...};
+}
+
+}  // namespace detail
+
+// Превращает вектор, который строит constexpr-функция Build, в std::array того же размера.
+// Память, выделенная при вычислении на этапе компиляции, не может его пережить, поэтому таблицу,
+// построенную вектором, сохраняют так: constexpr auto TABLE = FreezeVector<BuildTable>();
+// Build вызывается дважды: чтобы узнать размер массива и чтобы скопировать элементы
+template <auto Build>
+constexpr auto FreezeVector() {
+    return detail::FreezeVector<Build>(std::make_index_sequence<Build().Size()>{});
+}
+#endif
@@ -0,0 +1,490 @@
+#pragma once
+
+#include "vector.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#if !defined(__GNUC__)
+#error "vector_simd.h requires GCC or Clang vector extensions"
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#define VECTOR_SIMD_X86 1
+#else
+#define VECTOR_SIMD_X86 0
+#endif
+
+// Векторизованные операции над Vector и непрерывными буферами арифметических типов.
+// Ядра написаны на векторных расширениях GCC/Clang и компилируются в нескольких вариантах:
+// 16 байт (SSE2 на x86-64, NEON на AArch64), AVX2 и AVX-512. Вариант выбирается при первом
+// обращении по возможностям процессора, так что программу не нужно собирать с -mavx2
+// Регистры AVX передаются внутри встраиваемых ядер, а не через границу функций, поэтому
+// предупреждение об изменении ABI к ним не относится
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+namespace vector_simd {
+
+// Набор инструкций, которым пользуются операции. Baseline — 16-байтные регистры
+// (SSE2 или NEON; на других архитектурах компилятор разбивает их на скалярные операции)
+enum class SimdLevel { Baseline, Avx2, Avx512 };
+
+// Лучший набор инструкций, поддерживаемый процессором и операционной системой
+inline SimdLevel DetectedSimdLevel() noexcept {
+#if VECTOR_SIMD_X86
+    static const SimdLevel level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+            return SimdLevel::Avx512;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::Avx2;
+        }
+        return SimdLevel::Baseline;
+    }();
+    return level;
+#else
+    return SimdLevel::Baseline;
+#endif
+}
+
+namespace detail {
+
+inline std::atomic<SimdLevel>& ActiveLevel() noexcept {
+    static std::atomic<SimdLevel> level{DetectedSimdLevel()};
+    return level;
+}
+
+}  // namespace detail
+
+// Набор инструкций, которым пользуются операции сейчас
+inline SimdLevel CurrentSimdLevel() noexcept {
+    return detail::ActiveLevel().load(std::memory_order_relaxed);
+}
+
+// Ограничивает набор инструкций (например, для сравнения вариантов или обхода снижения частоты
+// процессора на AVX-512). Уровень выше поддерживаемого понижается до DetectedSimdLevel().
+// Возвращает установленный уровень
+inline SimdLevel SetSimdLevel(SimdLevel level) noexcept {
+    const SimdLevel applied = std::min(level, DetectedSimdLevel());
+    detail::ActiveLevel().store(applied, std::memory_order_relaxed);
+    return applied;
+}
+
+// Типы, для которых доступны операции: арифметические, кроме bool и long double
+template <typename T>
+inline constexpr bool is_simd_type_v =
+    std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && sizeof(T) <= sizeof(uint64_t);
+
+// Тип суммы: целые накапливаются в 64 битах (по модулю 2^64), вещественные — в самом типе
+template <typename T>
+using SumType = std::conditional_t<std::is_floating_point_v<T>, T,
+                                   std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+namespace detail {
+
+#define VECTOR_SIMD_INLINE __attribute__((always_inline)) inline
+
+template <typename T, size_t Bytes>
+struct VectorType {
+    typedef T type __attribute__((vector_size(Bytes)));
+};
+
+// Регистр из Bytes / sizeof(T) элементов T
+template <typename T, size_t Bytes>
+using Vec = typename VectorType<T, Bytes>::type;
+
+template <size_t Bytes>
+using Width = std::integral_constant<size_t, Bytes>;
+
+// Загрузка и запись по невыровненным адресам
+template <typename V, typename T>
+VECTOR_SIMD_INLINE V Load(const T* src) noexcept {
+    V result;
+    std::memcpy(&result, src, sizeof(V));
+    return result;
+}
+
+template <typename V, typename T>
+VECTOR_SIMD_INLINE void Store(T* dst, const V& value) noexcept {
+    std::memcpy(dst, &value, sizeof(V));
+}
+
+template <typename V, typename T>
+VECTOR_SIMD_INLINE V Broadcast(T value) noexcept {
+    V result{};
+    for (size_t i = 0; i < sizeof(V) / sizeof(T); ++i) {
+        result[i] = value;
+    }
+    return result;
+}
+
+// Истинно, если хотя бы один элемент маски сравнения ненулевой
+template <typename Mask>
+VECTOR_SIMD_INLINE bool AnyLane(const Mask& mask) noexcept {
+    uint64_t words[sizeof(Mask) / sizeof(uint64_t)];
+    std::memcpy(words, &mask, sizeof(Mask));
+    uint64_t any = 0;
+    for (uint64_t word : words) {
+        any |= word;
+    }
+    return any != 0;
+}
+
+// Ядра обрабатывают по Bytes байт за шаг, остаток — по одному элементу
+
+template <size_t Bytes, typename T>
+VECTOR_SIMD_INLINE void FillKernel(T* dst, size_t n, T value) noexcept {
+    using V = Vec<T, Bytes>;
+    constexpr size_t LANES = Bytes / sizeof(T);
+    const V block = Broadcast<V>(value);
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        Store(dst + i, block);
+    }
+    for (; i < n; ++i) {
+        dst[i] = value;
+    }
+}
+
+template <size_t Bytes, typename T>
+VECTOR_SIMD_INLINE bool EqualKernel(const T* lhs, const T* rhs, size_t n) noexcept {
+    using V = Vec<T, Bytes>;
+    constexpr size_t LANES = Bytes / sizeof(T);
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        if (AnyLane(Load<V>(lhs + i) != Load<V>(rhs + i))) {
+            return false;
+        }
+    }
+    for (; i < n; ++i) {
+        if (!(lhs[i] == rhs[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <size_t Bytes, typename T>
+VECTOR_SIMD_INLINE size_t FindKernel(const T* data, size_t n, T value) noexcept {
+    using V = Vec<T, Bytes>;
+    constexpr size_t LANES = Bytes / sizeof(T);
+    const V needle = Broadcast<V>(value);
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        if (AnyLane(Load<V>(data + i) == needle)) {
+            break;
+        }
+    }
+    for (; i < n; ++i) {
+        if (data[i] == value) {
+            return i;
+        }
+    }
+    return n;
+}
+
+template <size_t Bytes, typename T>
+VECTOR_SIMD_INLINE size_t CountKernel(const T* data, size_t n, T value) noexcept {
+    using V = Vec<T, Bytes>;
+    using Mask = decltype(V{} == V{});
+    constexpr size_t LANES = Bytes / sizeof(T);
+    // элементы маски равны -1 для совпадений; счётчики сбрасываются в size_t раньше, чем
+    // переполнится самый узкий (8-битный) элемент
+    constexpr size_t FLUSH_PERIOD = std::numeric_limits<int8_t>::max();
+    const V needle = Broadcast<V>(value);
+    size_t count = 0;
+    size_t i = 0;
+    while (i + LANES <= n) {
+        Mask lane_counts{};
+        for (size_t step = 0; step < FLUSH_PERIOD && i + LANES <= n; ++step, i += LANES) {
+            lane_counts -= Load<V>(data + i) == needle;
+        }
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            count += static_cast<size_t>(lane_counts[lane]);
+        }
+    }
+    for (; i < n; ++i) {
+        count += data[i] == value;
+    }
+    return count;
+}
+
+template <size_t Bytes, typename T>
+VECTOR_SIMD_INLINE SumType<T> SumKernel(const T* data, size_t n) noexcept {
+    using V = Vec<T, Bytes>;
+    constexpr size_t LANES = Bytes / sizeof(T);
+    if constexpr (std::is_floating_point_v<T>) {
+        // несколько независимых сумм скрывают задержку сложения
+        constexpr size_t ACCUMULATORS = 4;
+        V sums[ACCUMULATORS] = {};
+        size_t i = 0;
+        for (; i + LANES * ACCUMULATORS <= n; i += LANES * ACCUMULATORS) {
+            for (size_t k = 0; k < ACCUMULATORS; ++k) {
+                sums[k] += Load<V>(data + i + k * LANES);
+            }
+        }
+        for (; i + LANES <= n; i += LANES) {
+            sums[0] += Load<V>(data + i);
+        }
+        const V total = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+        T result = 0;
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            result += total[lane];
+        }
+        for (; i < n; ++i) {
+            result += data[i];
+        }
+        return result;
+    } else {
+        // элементы расширяются до 64 бит со знаком или без, а складываются без знака, чтобы
+        // переполнение было определено
+        using Wide = Vec<SumType<T>, LANES * sizeof(uint64_t)>;
+        using UnsignedWide = Vec<uint64_t, LANES * sizeof(uint64_t)>;
+        UnsignedWide sums{};
+        size_t i = 0;
+        for (; i + LANES <= n; i += LANES) {
+            sums += (UnsignedWide)__builtin_convertvector(Load<V>(data + i), Wide);
+        }
+        uint64_t result = 0;
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            result += sums[lane];
+        }
+        for (; i < n; ++i) {
+            result += static_cast<uint64_t>(static_cast<SumType<T>>(data[i]));
+        }
+        return static_cast<SumType<T>>(result);
+    }
+}
+
+template <size_t Bytes, typename T>
+VECTOR_SIMD_INLINE std::pair<T, T> MinMaxKernel(const T* data, size_t n) noexcept {
+    using V = Vec<T, Bytes>;
+    constexpr size_t LANES = Bytes / sizeof(T);
+    T min = data[0];
+    T max = data[0];
+    size_t i = 0;
+    if (n >= LANES) {
+        V mins = Load<V>(data);
+        V maxs = mins;
+        for (i = LANES; i + LANES <= n; i += LANES) {
+            const V block = Load<V>(data + i);
+            mins = block < mins ? block : mins;
+            maxs = block > maxs ? block : maxs;
+        }
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            min = mins[lane] < min ? mins[lane] : min;
+            max = maxs[lane] > max ? maxs[lane] : max;
+        }
+    }
+    for (; i < n; ++i) {
+        min = data[i] < min ? data[i] : min;
+        max = data[i] > max ? data[i] : max;
+    }
+    return {min, max};
+}
+
+// Пользовательская op может не встроиться, поэтому ей передаются только 16-байтные регистры:
+// их передача в функции одинакова при любом наборе инструкций. Широкие регистры обрабатываются
+// по частям, которые после встраивания op компилятор объединяет
+template <size_t Bytes, typename T, typename UnaryOp>
+VECTOR_SIMD_INLINE void TransformKernel(const T* src, T* dst, size_t n, UnaryOp& op) {
+    using V = Vec<T, 16>;
+    constexpr size_t LANES = 16 / sizeof(T);
+    constexpr size_t PARTS = Bytes / 16;
+    size_t i = 0;
+    if constexpr (std::is_invocable_r_v<V, UnaryOp&, V>) {
+        for (; i + LANES * PARTS <= n; i += LANES * PARTS) {
+            for (size_t part = 0; part < PARTS; ++part) {
+                Store(dst + i + part * LANES, static_cast<V>(op(Load<V>(src + i + part * LANES))));
+            }
+        }
+        for (; i + LANES <= n; i += LANES) {
+            Store(dst + i, static_cast<V>(op(Load<V>(src + i))));
+        }
+    }
+    for (; i < n; ++i) {
+        dst[i] = static_cast<T>(op(src[i]));
+    }
+}
+
+// Варианты запуска ядра: kernel вызывается с шириной регистра и встраивается в функцию,
+// скомпилированную для соответствующего набора инструкций
+#if VECTOR_SIMD_X86
+template <typename Kernel>
+__attribute__((target("avx512f,avx512bw"))) decltype(auto) RunAvx512(Kernel& kernel) {
+    return kernel(Width<64>{});
+}
+
+template <typename Kernel>
+__attribute__((target("avx2"))) decltype(auto) RunAvx2(Kernel& kernel) {
+    return kernel(Width<32>{});
+}
+#endif
+
+template <typename Kernel>
+decltype(auto) RunBaseline(Kernel& kernel) {
+    return kernel(Width<16>{});
+}
+
+template <typename Kernel>
+decltype(auto) Dispatch(Kernel kernel) {
+#if VECTOR_SIMD_X86
+    switch (CurrentSimdLevel()) {
+        case SimdLevel::Avx512:
+            return RunAvx512(kernel);
+        case SimdLevel::Avx2:
+            return RunAvx2(kernel);
+        case SimdLevel::Baseline:
+            break;
+    }
+#endif
+    return RunBaseline(kernel);
+}
+
+template <typename T>
+using RequireSimdType = std::enable_if_t<is_simd_type_v<T>>;
+
+}  // namespace detail
+
+// Операции над буфером [data, data + n)
+
+template <typename T, typename = detail::RequireSimdType<T>>
+void Fill(T* data, size_t n, T value) noexcept {
+    detail::Dispatch([&](auto width) __attribute__((always_inline)) {
+        detail::FillKernel<width>(data, n, value);
+    });
+}
+
+template <typename T, typename = detail::RequireSimdType<T>>
+bool Equal(const T* lhs, const T* rhs, size_t n) noexcept {
+    return detail::Dispatch([&](auto width) __attribute__((always_inline)) {
+        return detail::EqualKernel<width>(lhs, rhs, n);
+    });
+}
+
+// Индекс первого элемента, равного value, или n, если такого нет
+template <typename T, typename = detail::RequireSimdType<T>>
+size_t Find(const T* data, size_t n, T value) noexcept {
+    return detail::Dispatch([&](auto width) __attribute__((always_inline)) {
+        return detail::FindKernel<width>(data, n, value);
+    });
+}
+
+template <typename T, typename = detail::RequireSimdType<T>>
+size_t Count(const T* data, size_t n, T value) noexcept {
+    return detail::Dispatch([&](auto width) __attribute__((always_inline)) {
+        return detail::CountKernel<width>(data, n, value);
+    });
+}
+
+// Сумма элементов. Вещественные слагаемые складываются в другом порядке, чем при последовательном
+// сложении, поэтому результат может отличаться в последних разрядах и зависеть от набора инструкций
+template <typename T, typename = detail::RequireSimdType<T>>
+SumType<T> Sum(const T* data, size_t n) noexcept {
+    return detail::Dispatch([&](auto width) __attribute__((always_inline)) {
+        return detail::SumKernel<width>(data, n);
+    });
+}
+
+// Наименьший и наибольший элементы непустого буфера. Результат при наличии NaN не определён
+template <typename T, typename = detail::RequireSimdType<T>>
+std::pair<T, T> MinMax(const T* data, size_t n) noexcept {
+    VECTOR_CHECK(n > 0, "MinMax of empty range");
+    return detail::Dispatch([&](auto width) __attribute__((always_inline)) {
+        return detail::MinMaxKernel<width>(data, n);
+    });
+}
+
+// dst[i] = op(src[i]); src и dst могут совпадать. Если op можно вызвать и для регистра
+// (например, обобщённая лямбда с арифметикой: [](auto x) { return x * 2 + 1; }),
+// она применяется сразу к 16 / sizeof(T) элементам
+template <typename T, typename UnaryOp, typename = detail::RequireSimdType<T>>
+void Transform(const T* src, T* dst, size_t n, UnaryOp op) {
+    detail::Dispatch([&](auto width) __attribute__((always_inline)) {
+        detail::TransformKernel<width>(src, dst, n, op);
+    });
+}
+
+// Операции над Vector
+
+template <typename T, typename Allocator, typename GrowthPolicy, typename = detail::RequireSimdType<T>>
+void Fill(Vector<T, Allocator, GrowthPolicy>& v, T value) noexcept {
+    Fill(v.Data(), v.Size(), value);
+}
+
+template <typename T, typename A1, typename G1, typename A2, typename G2, typename = detail::RequireSimdType<T>>
+bool Equal(const Vector<T, A1, G1>& lhs, const Vector<T, A2, G2>& rhs) noexcept {
+    return lhs.Size() == rhs.Size() && Equal(lhs.Data(), rhs.Data(), lhs.Size());
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, typename = detail::RequireSimdType<T>>
+auto Find(Vector<T, Allocator, GrowthPolicy>& v, T value) noexcept {
+    return v.begin() + Find(v.Data(), v.Size(), value);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, typename = detail::RequireSimdType<T>>
+auto Find(const Vector<T, Allocator, GrowthPolicy>& v, T value) noexcept {
+    return v.begin() + Find(v.Data(), v.Size(), value);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, typename = detail::RequireSimdType<T>>
+size_t Count(const Vector<T, Allocator, GrowthPolicy>& v, T value) noexcept {
+    return Count(v.Data(), v.Size(), value);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, typename = detail::RequireSimdType<T>>
+SumType<T> Sum(const Vector<T, Allocator, GrowthPolicy>& v) noexcept {
+    return Sum(v.Data(), v.Size());
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, typename = detail::RequireSimdType<T>>
+std::pair<T, T> MinMax(const Vector<T, Allocator, GrowthPolicy>& v) noexcept {
+    return MinMax(v.Data(), v.Size());
+}
+
+// Записывает в dst результаты op для элементов src. dst может быть тем же вектором
+template <typename T, typename A1, typename G1, typename A2, typename G2, typename UnaryOp,
+          typename = detail::RequireSimdType<T>>
+void Transform(const Vector<T, A1, G1>& src, Vector<T, A2, G2>& dst, UnaryOp op) {
+    dst.Resize(src.Size());
+    Transform(src.Data(), dst.Data(), src.Size(), op);
+}
+
+// Заменяет содержимое v копией буфера [data, data + n). Элементы тривиально копируемы,
+// поэтому копирование сводится к memmove, а буфер перевыделяется не более одного раза
+template <typename T, typename Allocator, typename GrowthPolicy, typename = detail::RequireSimdType<T>>
+void CopyFrom(Vector<T, Allocator, GrowthPolicy>& v, const T* data, size_t n) {
+    v.Assign(data, data + n);
+}
+
+// То же для непрерывного участка с методами Data() и Size() (ColumnSpan, Vector)
+template <typename T, typename Allocator, typename GrowthPolicy, typename Span,
+          typename = detail::RequireSimdType<T>>
+auto CopyFrom(Vector<T, Allocator, GrowthPolicy>& v, const Span& span)
+    -> decltype(static_cast<const T*>(span.Data()), span.Size(), void()) {
+    CopyFrom(v, static_cast<const T*>(span.Data()), span.Size());
+}
+
+}  // namespace vector_simd
+
+// Поэлементное сравнение векторов арифметических типов
+template <typename T, typename A1, typename G1, typename A2, typename G2,
+          typename = vector_simd::detail::RequireSimdType<T>>
+bool operator==(const Vector<T, A1, G1>& lhs, const Vector<T, A2, G2>& rhs) noexcept {
+    return vector_simd::Equal(lhs, rhs);
+}
+
+template <typename T, typename A1, typename G1, typename A2, typename G2,
+          typename = vector_simd::detail::RequireSimdType<T>>
+bool operator!=(const Vector<T, A1, G1>& lhs, const Vector<T, A2, G2>& rhs) noexcept {
+    return !vector_simd::Equal(lhs, rhs);
+}
+
+#pragma GCC diagnostic pop
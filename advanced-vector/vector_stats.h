@@ -0,0 +1,191 @@
+#pragma once
+
+#include "demangle.h"
+
+#include <atomic>
+#include <cstddef>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+// Статистика выделений памяти и переноса элементов векторами библиотеки, собираемая по типам элементов.
+// Включается макросом VECTOR_ENABLE_STATS, определённым до подключения vector.h
+// (например, -DVECTOR_ENABLE_STATS). Без него счётчики не вызываются и ничего не стоят.
+// Счётчики атомарные, поэтому векторы можно использовать из разных потоков
+namespace vector_stats {
+
+// Снимок счётчиков для одного типа элементов
+struct Counters {
+    // выделения и освобождения буферов
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    // переносы элементов в новый буфер (Reserve, рост при вставке, ShrinkToFit...)
+    size_t reallocations = 0;
+    // перенесённые элементы: перемещением, копированием (конструктор перемещения может
+    // выбросить исключение) и побайтово (тип тривиально перемещаем)
+    size_t elements_moved = 0;
+    size_t elements_copied = 0;
+    size_t elements_relocated = 0;
+    // наибольшая вместимость одного буфера, в элементах
+    size_t peak_capacity = 0;
+    // вместимость всех живых буферов и её максимум, в элементах
+    size_t live_capacity = 0;
+    size_t peak_live_capacity = 0;
+    // незанятые ячейки буферов на момент разрушения векторов и число разрушенных векторов
+    size_t wasted_capacity = 0;
+    size_t releases = 0;
+};
+
+class TypeStats {
+public:
+    explicit TypeStats(const char* mangled_name)
+        : name_(detail::DemangledName(mangled_name).Get()) {
+        next_ = head_.load(std::memory_order_relaxed);
+        while (!head_.compare_exchange_weak(next_, this, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    TypeStats(const TypeStats&) = delete;
+    TypeStats& operator=(const TypeStats&) = delete;
+
+    void OnAllocate(size_t capacity) noexcept {
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        UpdateMax(peak_capacity_, capacity);
+        const size_t live = live_capacity_.fetch_add(capacity, std::memory_order_relaxed) + capacity;
+        UpdateMax(peak_live_capacity_, live);
+    }
+
+    void OnDeallocate(size_t capacity) noexcept {
+        deallocations_.fetch_add(1, std::memory_order_relaxed);
+        live_capacity_.fetch_sub(capacity, std::memory_order_relaxed);
+    }
+
+    void OnReallocate() noexcept {
+        reallocations_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void OnMove(size_t n) noexcept {
+        elements_moved_.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void OnCopy(size_t n) noexcept {
+        elements_copied_.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void OnRelocateBytes(size_t n) noexcept {
+        elements_relocated_.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void OnRelease(size_t capacity, size_t size) noexcept {
+        wasted_capacity_.fetch_add(capacity - size, std::memory_order_relaxed);
+        releases_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const std::string& Name() const noexcept {
+        return name_;
+    }
+
+    Counters Snapshot() const noexcept {
+        Counters result;
+        result.allocations = allocations_.load(std::memory_order_relaxed);
+        result.deallocations = deallocations_.load(std::memory_order_relaxed);
+        result.reallocations = reallocations_.load(std::memory_order_relaxed);
+        result.elements_moved = elements_moved_.load(std::memory_order_relaxed);
+        result.elements_copied = elements_copied_.load(std::memory_order_relaxed);
+        result.elements_relocated = elements_relocated_.load(std::memory_order_relaxed);
+        result.peak_capacity = peak_capacity_.load(std::memory_order_relaxed);
+        result.live_capacity = live_capacity_.load(std::memory_order_relaxed);
+        result.peak_live_capacity = peak_live_capacity_.load(std::memory_order_relaxed);
+        result.wasted_capacity = wasted_capacity_.load(std::memory_order_relaxed);
+        result.releases = releases_.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    // Обнуляет счётчики. Вместимость живых буферов сохраняется, иначе она станет отрицательной
+    // после их освобождения
+    void Reset() noexcept {
+        for (auto* counter : {&allocations_, &deallocations_, &reallocations_, &elements_moved_, &elements_copied_,
+                              &elements_relocated_, &wasted_capacity_, &releases_}) {
+            counter->store(0, std::memory_order_relaxed);
+        }
+        const size_t live = live_capacity_.load(std::memory_order_relaxed);
+        peak_capacity_.store(0, std::memory_order_relaxed);
+        peak_live_capacity_.store(live, std::memory_order_relaxed);
+    }
+
+    const TypeStats* Next() const noexcept {
+        return next_;
+    }
+
+    static const TypeStats* First() noexcept {
+        return head_.load(std::memory_order_acquire);
+    }
+
+private:
+    static void UpdateMax(std::atomic<size_t>& target, size_t value) noexcept {
+        size_t current = target.load(std::memory_order_relaxed);
+        while (current < value && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    std::string name_;
+    std::atomic<size_t> allocations_ = 0;
+    std::atomic<size_t> deallocations_ = 0;
+    std::atomic<size_t> reallocations_ = 0;
+    std::atomic<size_t> elements_moved_ = 0;
+    std::atomic<size_t> elements_copied_ = 0;
+    std::atomic<size_t> elements_relocated_ = 0;
+    std::atomic<size_t> peak_capacity_ = 0;
+    std::atomic<size_t> live_capacity_ = 0;
+    std::atomic<size_t> peak_live_capacity_ = 0;
+    std::atomic<size_t> wasted_capacity_ = 0;
+    std::atomic<size_t> releases_ = 0;
+
+    // Все когда-либо использованные типы образуют односвязный список, в который только добавляют
+    TypeStats* next_ = nullptr;
+    static inline std::atomic<TypeStats*> head_ = nullptr;
+};
+
+// Счётчики для векторов с элементами типа T. Регистрируются при первом обращении
+template <typename T>
+TypeStats& For() {
+    static TypeStats stats(typeid(T).name());
+    return stats;
+}
+
+// Снимки счётчиков всех зарегистрированных типов
+inline std::vector<std::pair<std::string, Counters>> Collect() {
+    std::vector<std::pair<std::string, Counters>> result;
+    for (const TypeStats* stats = TypeStats::First(); stats != nullptr; stats = stats->Next()) {
+        result.emplace_back(stats->Name(), stats->Snapshot());
+    }
+    return result;
+}
+
+// Обнуляет счётчики всех типов
+inline void Reset() noexcept {
+    for (const TypeStats* stats = TypeStats::First(); stats != nullptr; stats = stats->Next()) {
+        const_cast<TypeStats*>(stats)->Reset();
+    }
+}
+
+// Выводит таблицу счётчиков по типам. Потерянная вместимость — среднее число незанятых
+// ячеек буфера на момент разрушения вектора
+inline void Dump(std::ostream& out) {
+    out << std::left << std::setw(32) << "type" << std::right << std::setw(8) << "allocs" << std::setw(8)
+        << "reallocs" << std::setw(10) << "moved" << std::setw(10) << "copied" << std::setw(10) << "relocated"
+        << std::setw(12) << "peak cap" << std::setw(12) << "live cap" << std::setw(12) << "avg wasted" << '\n';
+    for (const auto& [name, counters] : Collect()) {
+        const size_t avg_wasted = counters.releases != 0 ? counters.wasted_capacity / counters.releases : 0;
+        out << std::left << std::setw(32) << name << std::right << std::setw(8) << counters.allocations
+            << std::setw(8) << counters.reallocations << std::setw(10) << counters.elements_moved << std::setw(10)
+            << counters.elements_copied << std::setw(10) << counters.elements_relocated << std::setw(12)
+            << counters.peak_capacity << std::setw(12) << counters.live_capacity << std::setw(12) << avg_wasted
+            << '\n';
+    }
+}
+
+}  // namespace vector_stats
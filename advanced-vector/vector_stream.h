@@ -0,0 +1,264 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Потоковое чтение и запись векторов тривиально копируемых записей кусками по StreamOptions::chunk_bytes.
+// Куски читаются прямо в неинициализированный хвост буфера вектора (Vector::PrepareAppend), поэтому
+// число системных вызовов равно числу кусков, а элементы не копируются через промежуточный буфер.
+// Для обычного файла буфер резервируется один раз под весь остаток файла, для каналов и сокетов
+// растёт по политике роста вектора
+namespace vector_stream {
+
+struct StreamOptions {
+    static constexpr size_t DEFAULT_CHUNK_BYTES = 1 << 20;
+
+    // Размер одного чтения или записи
+    size_t chunk_bytes = DEFAULT_CHUNK_BYTES;
+    // Для обычных файлов: сообщать ядру о последовательном чтении и заранее запрашивать следующий кусок
+    // (posix_fadvise), чтобы он подгружался с диска, пока обрабатывается текущий
+    bool prefetch = true;
+};
+
+namespace detail {
+
+[[noreturn]] inline void ThrowSystemError(const char* what) {
+    throw std::system_error(errno, std::generic_category(), std::string("vector_stream: ") + what);
+}
+
+// Сколько целых записей по record_size байт помещается в кусок (хотя бы одна)
+inline size_t ChunkRecords(const StreamOptions& options, size_t record_size) noexcept {
+    return std::max<size_t>(1, options.chunk_bytes / record_size);
+}
+
+}  // namespace detail
+
+// Читает записи T из дескриптора fd в конец вектора. Запись может прийти по частям в разных вызовах read:
+// неполный хвост куска сохраняется и дописывается при следующем чтении
+template <typename T>
+class ChunkedReader {
+    static_assert(std::is_trivially_copyable_v<T>, "Records are read as raw bytes");
+
+public:
+    explicit ChunkedReader(int fd, const StreamOptions& options = {})
+        : fd_(fd)
+        , options_(options) {
+        struct stat st {};
+        if (::fstat(fd_, &st) != 0) {
+            detail::ThrowSystemError("fstat");
+        }
+        if (S_ISREG(st.st_mode)) {
+            const off_t position = ::lseek(fd_, 0, SEEK_CUR);
+            if (position >= 0) {
+                regular_file_ = true;
+                position_ = position;
+                file_size_ = st.st_size;
+            }
+        }
+#ifdef POSIX_FADV_SEQUENTIAL
+        if (regular_file_ && options_.prefetch) {
+            ::posix_fadvise(fd_, position_, 0, POSIX_FADV_SEQUENTIAL);
+        }
+#endif
+    }
+
+    // Дочитан ли поток до конца
+    bool Eof() const noexcept {
+        return eof_;
+    }
+
+    // Дописывает в v записи из очередного куска (один системный вызов read, если не прервётся сигналом)
+    // и возвращает их число; 0 — конец потока. Если поток кончился посреди записи,
+    // выбрасывает std::runtime_error
+    template <typename Allocator, typename GrowthPolicy>
+    size_t ReadChunk(Vector<T, Allocator, GrowthPolicy>& v) {
+        while (!eof_) {
+            const size_t count = ReadOnce(v);
+            if (count != 0) {
+                return count;
+            }
+        }
+        return 0;
+    }
+
+    // Дочитывает поток до конца и возвращает число добавленных записей
+    template <typename Allocator, typename GrowthPolicy>
+    size_t ReadAll(Vector<T, Allocator, GrowthPolicy>& v) {
+        if (regular_file_ && file_size_ > position_) {
+            v.Reserve(v.Size() + CarryRecords(static_cast<size_t>(file_size_ - position_)));
+        }
+        size_t total = 0;
+        while (!eof_) {
+            total += ReadOnce(v);
+        }
+        return total;
+    }
+
+private:
+    // Число записей в remaining байтах, оставшихся в файле, с учётом неполной записи из прошлого куска
+    size_t CarryRecords(size_t remaining) const noexcept {
+        return (remaining + carry_size_) / sizeof(T);
+    }
+
+    template <typename Allocator, typename GrowthPolicy>
+    size_t ReadOnce(Vector<T, Allocator, GrowthPolicy>& v) {
+        // сначала используется уже выделенный хвост, чтобы не расширять буфер, зарезервированный точно
+        // под размер файла; у его конца конец файла проверяется без чтения
+        size_t room = v.Capacity() - v.Size();
+        if (room * sizeof(T) <= carry_size_) {
+            if (regular_file_ && carry_size_ == 0 && AtEndOfFile()) {
+                eof_ = true;
+                return 0;
+            }
+            v.PrepareAppend(detail::ChunkRecords(options_, sizeof(T)));
+            room = v.Capacity() - v.Size();
+        }
+        const size_t chunk = std::min(room, detail::ChunkRecords(options_, sizeof(T)));
+        auto* const bytes = reinterpret_cast<unsigned char*>(v.Data() + v.Size());
+        std::memcpy(bytes, carry_, carry_size_);
+
+        ssize_t got;
+        do {
+            got = ::read(fd_, bytes + carry_size_, chunk * sizeof(T) - carry_size_);
+        } while (got < 0 && errno == EINTR);
+        if (got < 0) {
+            detail::ThrowSystemError("read");
+        }
+        if (got == 0) {
+            eof_ = true;
+            if (carry_size_ != 0) {
+                throw std::runtime_error("vector_stream: stream ends in the middle of a record");
+            }
+            return 0;
+        }
+        position_ += got;
+        Prefetch();
+
+        const size_t filled = carry_size_ + static_cast<size_t>(got);
+        const size_t count = filled / sizeof(T);
+        carry_size_ = filled % sizeof(T);
+        std::memcpy(carry_, bytes + count * sizeof(T), carry_size_);
+        v.CommitAppend(count);
+        return count;
+    }
+
+    // Файл мог вырасти после открытия, поэтому его размер перечитывается
+    bool AtEndOfFile() {
+        struct stat st {};
+        if (::fstat(fd_, &st) != 0) {
+            detail::ThrowSystemError("fstat");
+        }
+        file_size_ = st.st_size;
+        return position_ >= file_size_;
+    }
+
+    void Prefetch() noexcept {
+#ifdef POSIX_FADV_WILLNEED
+        if (regular_file_ && options_.prefetch && position_ < file_size_) {
+            ::posix_fadvise(fd_, position_, static_cast<off_t>(options_.chunk_bytes), POSIX_FADV_WILLNEED);
+        }
+#endif
+    }
+
+    int fd_;
+    StreamOptions options_;
+    bool regular_file_ = false;
+    bool eof_ = false;
+    off_t position_ = 0;
+    off_t file_size_ = 0;
+    // начало неполной записи из прошлого куска
+    unsigned char carry_[sizeof(T)] = {};
+    size_t carry_size_ = 0;
+};
+
+// Дочитывает записи из fd до конца потока в конец v. Возвращает число добавленных записей
+template <typename T, typename Allocator, typename GrowthPolicy>
+size_t ReadAll(int fd, Vector<T, Allocator, GrowthPolicy>& v, const StreamOptions& options = {}) {
+    return ChunkedReader<T>(fd, options).ReadAll(v);
+}
+
+// То же для std::istream. Куски читаются через istream::read прямо в хвост буфера
+template <typename T, typename Allocator, typename GrowthPolicy>
+size_t ReadAll(std::istream& in, Vector<T, Allocator, GrowthPolicy>& v, const StreamOptions& options = {}) {
+    static_assert(std::is_trivially_copyable_v<T>, "Records are read as raw bytes");
+    const size_t chunk = detail::ChunkRecords(options, sizeof(T));
+    const size_t old_size = v.Size();
+    unsigned char carry[sizeof(T)];
+    size_t carry_size = 0;
+    while (in) {
+        auto* const bytes = reinterpret_cast<char*>(v.PrepareAppend(chunk));
+        std::memcpy(bytes, carry, carry_size);
+        in.read(bytes + carry_size, static_cast<std::streamsize>(chunk * sizeof(T) - carry_size));
+        const size_t filled = carry_size + static_cast<size_t>(in.gcount());
+        const size_t count = filled / sizeof(T);
+        // неполная запись переносится в начало следующего куска
+        carry_size = filled % sizeof(T);
+        std::memcpy(carry, bytes + count * sizeof(T), carry_size);
+        v.CommitAppend(count);
+    }
+    if (in.bad()) {
+        throw std::runtime_error("vector_stream: stream read failed");
+    }
+    if (carry_size != 0) {
+        throw std::runtime_error("vector_stream: stream ends in the middle of a record");
+    }
+    return v.Size() - old_size;
+}
+
+// Записывает count записей из data в fd кусками, продолжая после частичной записи
+template <typename T>
+void WriteAll(int fd, const T* data, size_t count, const StreamOptions& options = {}) {
+    static_assert(std::is_trivially_copyable_v<T>, "Records are written as raw bytes");
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+    size_t remaining = count * sizeof(T);
+    const size_t chunk_bytes = detail::ChunkRecords(options, sizeof(T)) * sizeof(T);
+    while (remaining > 0) {
+        const ssize_t written = ::write(fd, bytes, std::min(remaining, chunk_bytes));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            detail::ThrowSystemError("write");
+        }
+        bytes += written;
+        remaining -= static_cast<size_t>(written);
+    }
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+void WriteAll(int fd, const Vector<T, Allocator, GrowthPolicy>& v, const StreamOptions& options = {}) {
+    WriteAll(fd, v.Data(), v.Size(), options);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+void WriteAll(std::ostream& out, const Vector<T, Allocator, GrowthPolicy>& v, const StreamOptions& options = {}) {
+    static_assert(std::is_trivially_copyable_v<T>, "Records are written as raw bytes");
+    const auto* bytes = reinterpret_cast<const char*>(v.Data());
+    size_t remaining = v.Size() * sizeof(T);
+    const size_t chunk_bytes = detail::ChunkRecords(options, sizeof(T)) * sizeof(T);
+    while (remaining > 0 && out) {
+        const size_t n = std::min(remaining, chunk_bytes);
+        out.write(bytes, static_cast<std::streamsize>(n));
+        bytes += n;
+        remaining -= n;
+    }
+    if (!out) {
+        throw std::runtime_error("vector_stream: stream write failed");
+    }
+}
+
+}  // namespace vector_stream
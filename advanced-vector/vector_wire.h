@@ -0,0 +1,305 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Двоичный формат для передачи векторов тривиально копируемых элементов между процессами:
+// заголовок фиксированного размера HEADER_SIZE, за которым следует буфер элементов как есть.
+// Порядок байтов и представление элементов не преобразуются, поэтому формат предназначен для
+// обмена между процессами на машинах одной архитектуры
+namespace vector_wire {
+
+inline constexpr uint64_t MAGIC = 0x31525745'56444441;  // "ADDVEWR1" в порядке байтов little-endian
+inline constexpr uint32_t FORMAT_VERSION = 1;
+// Размер заголовка; элементы начинаются с этого смещения, поэтому их выравнивание не больше него
+inline constexpr size_t HEADER_SIZE = 64;
+// Из потока неизвестной длины элементы читаются в буфер, растущий от этого размера вдвое по мере поступления
+inline constexpr size_t STREAM_CHUNK_BYTES = 1024 * 1024;
+
+struct Header {
+    uint64_t magic = MAGIC;
+    uint32_t version = FORMAT_VERSION;
+    uint32_t element_size = 0;
+    uint32_t element_align = 0;
+    uint32_t reserved = 0;
+    uint64_t count = 0;
+    // Checksum буфера элементов
+    uint64_t checksum = 0;
+};
+
+static_assert(sizeof(Header) <= HEADER_SIZE && std::is_trivially_copyable_v<Header>);
+
+// Некриптографическая контрольная сумма для обнаружения повреждений: четыре независимые
+// мультипликативные цепочки по 8 байт, обрабатываемые параллельно, и перемешивание в конце
+inline uint64_t Checksum(const void* data, size_t size) noexcept {
+    constexpr uint64_t PRIME = 0x00000100'000001b3;
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    uint64_t lanes[4] = {0xcbf29ce4'84222325, 0x84222325'cbf29ce4, 0x9e3779b9'7f4a7c15, 0x7f4a7c15'9e3779b9};
+    size_t i = 0;
+    for (; i + sizeof(lanes) <= size; i += sizeof(lanes)) {
+        for (size_t k = 0; k < 4; ++k) {
+            uint64_t word;
+            std::memcpy(&word, bytes + i + k * sizeof(word), sizeof(word));
+            lanes[k] = (lanes[k] ^ word) * PRIME;
+        }
+    }
+    uint64_t hash = size;
+    for (uint64_t lane : lanes) {
+        hash = (hash ^ lane) * PRIME;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * PRIME;
+    }
+    // финальное перемешивание splitmix64
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d'1ce4e5b9;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb'133111eb;
+    return hash ^ (hash >> 31);
+}
+
+// Заголовок для count элементов, начинающихся с data
+template <typename T>
+Header MakeHeader(const T* data, size_t count) noexcept {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements can be sent as bytes");
+    static_assert(alignof(T) <= HEADER_SIZE, "Element alignment is limited by the header size");
+    Header header;
+    header.element_size = sizeof(T);
+    header.element_align = alignof(T);
+    header.count = count;
+    header.checksum = Checksum(data, count * sizeof(T));
+    return header;
+}
+
+// Проверяет, что заголовок описывает элементы типа T. Выбрасывает std::runtime_error
+template <typename T>
+void CheckHeader(const Header& header) {
+    if (header.magic != MAGIC) {
+        throw std::runtime_error("vector_wire: bad magic");
+    }
+    if (header.version != FORMAT_VERSION) {
+        throw std::runtime_error("vector_wire: unsupported format version " + std::to_string(header.version));
+    }
+    if (header.element_size != sizeof(T) || header.element_align != alignof(T)) {
+        throw std::runtime_error("vector_wire: element type does not match");
+    }
+    if (header.count > std::numeric_limits<std::ptrdiff_t>::max() / sizeof(T)) {
+        throw std::length_error("vector_wire: element count overflow");
+    }
+}
+
+// Размер сообщения с count элементами T
+template <typename T>
+constexpr size_t MessageSize(size_t count) noexcept {
+    return HEADER_SIZE + count * sizeof(T);
+}
+
+namespace detail {
+
+[[noreturn]] inline void ThrowSystemError(const char* what) {
+    throw std::system_error(errno, std::generic_category(), std::string("vector_wire: ") + what);
+}
+
+// Записывает все iovcnt участков, продолжая после частичной записи
+inline void WriteAll(int fd, iovec* iov, int iovcnt) {
+    while (iovcnt > 0) {
+        const ssize_t written = ::writev(fd, iov, iovcnt);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowSystemError("writev");
+        }
+        size_t remaining = static_cast<size_t>(written);
+        while (iovcnt > 0 && remaining >= iov->iov_len) {
+            remaining -= iov->iov_len;
+            ++iov;
+            --iovcnt;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + remaining;
+            iov->iov_len -= remaining;
+        }
+    }
+}
+
+// Читает ровно size байт. Конец потока раньше времени — ошибка формата
+inline void ReadAll(int fd, void* dst, size_t size) {
+    auto* out = static_cast<char*>(dst);
+    while (size > 0) {
+        const ssize_t got = ::read(fd, out, size);
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowSystemError("read");
+        }
+        if (got == 0) {
+            throw std::runtime_error("vector_wire: unexpected end of stream");
+        }
+        out += got;
+        size -= static_cast<size_t>(got);
+    }
+}
+
+// Число байт от текущей позиции до конца fd, если это обычный файл; -1 для каналов, сокетов и т.п.
+inline off_t RemainingFileBytes(int fd) noexcept {
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return -1;
+    }
+    const off_t pos = ::lseek(fd, 0, SEEK_CUR);
+    return pos < 0 ? -1 : std::max<off_t>(st.st_size - pos, 0);
+}
+
+}  // namespace detail
+
+// Записывает v в дескриптор fd одним вызовом writev: заголовок и буфер элементов без промежуточного копирования
+template <typename T, typename Allocator, typename GrowthPolicy>
+void WriteTo(int fd, const Vector<T, Allocator, GrowthPolicy>& v) {
+    unsigned char header_bytes[HEADER_SIZE] = {};
+    const Header header = MakeHeader(v.Data(), v.Size());
+    std::memcpy(header_bytes, &header, sizeof(header));
+    iovec iov[2] = {{header_bytes, HEADER_SIZE},
+                    {const_cast<T*>(v.Data()), v.Size() * sizeof(T)}};
+    detail::WriteAll(fd, iov, v.Size() != 0 ? 2 : 1);
+}
+
+// Читает вектор, записанный WriteTo. Элементы читаются прямо в буфер нового вектора.
+// При несовпадении типа, повреждении или обрыве потока выбрасывает исключение.
+// Число элементов из заголовка не доверяется: для обычного файла оно сверяется с остатком файла до
+// выделения памяти, а из канала или сокета элементы читаются в буфер, растущий по мере поступления данных,
+// поэтому повреждённый заголовок не заставит выделить больше удвоенного объёма реально полученных байт
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth>
+Vector<T, Allocator, GrowthPolicy> ReadFrom(int fd, const Allocator& alloc = Allocator()) {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements can be received as bytes");
+    unsigned char header_bytes[HEADER_SIZE];
+    detail::ReadAll(fd, header_bytes, HEADER_SIZE);
+    Header header;
+    std::memcpy(&header, header_bytes, sizeof(header));
+    CheckHeader<T>(header);
+    const size_t count = static_cast<size_t>(header.count);
+    const off_t file_bytes = detail::RemainingFileBytes(fd);
+    RawMemory<T, Allocator> data(alloc);
+    if (file_bytes >= 0) {
+        if (static_cast<uint64_t>(file_bytes) / sizeof(T) < count) {
+            throw std::runtime_error("vector_wire: unexpected end of stream");
+        }
+        RawMemory<T, Allocator>(count, alloc).Swap(data);
+        detail::ReadAll(fd, data.GetAddress(), count * sizeof(T));
+    } else {
+        const size_t chunk = std::max<size_t>(STREAM_CHUNK_BYTES / sizeof(T), 1);
+        size_t received = 0;
+        while (received < count) {
+            const size_t capacity = std::min(count, std::max(chunk, received * 2));
+            RawMemory<T, Allocator> grown(capacity, alloc);
+            if (received != 0) {
+                std::memcpy(static_cast<void*>(grown.GetAddress()), data.GetAddress(), received * sizeof(T));
+            }
+            data.Swap(grown);
+            detail::ReadAll(fd, data.GetAddress() + received, (capacity - received) * sizeof(T));
+            received = capacity;
+        }
+    }
+    if (Checksum(data.GetAddress(), count * sizeof(T)) != header.checksum) {
+        throw std::runtime_error("vector_wire: checksum mismatch");
+    }
+    return Vector<T, Allocator, GrowthPolicy>(std::move(data), count);
+}
+
+}  // namespace vector_wire
+
+// Невладеющий вид на элементы сообщения vector_wire, уже находящегося в памяти (например, в буфере
+// приёма RPC). Элементы не копируются, поэтому буфер сообщения должен жить дольше вида и быть
+// выровнен так, чтобы элементы по смещению HEADER_SIZE были выровнены по alignof(T)
+template <typename T>
+class VectorView {
+    static_assert(std::is_trivially_copyable_v<T>, "VectorView reads elements as raw bytes");
+
+public:
+    using value_type = T;
+    using iterator = const T*;
+    using const_iterator = const T*;
+
+    VectorView() = default;
+
+    VectorView(const T* data, size_t size) noexcept
+        : data_(data)
+        , size_(size) {
+    }
+
+    template <typename Allocator, typename GrowthPolicy>
+    VectorView(const Vector<T, Allocator, GrowthPolicy>& v) noexcept
+        : VectorView(v.Data(), v.Size()) {
+    }
+
+    // Разбирает сообщение [message, message + size). Выбрасывает std::runtime_error, если сообщение
+    // обрезано, не соответствует T или повреждено (контрольная сумма проверяется, если verify_checksum)
+    static VectorView FromMessage(const void* message, size_t size, bool verify_checksum = true) {
+        if (size < vector_wire::HEADER_SIZE) {
+            throw std::runtime_error("vector_wire: message is shorter than its header");
+        }
+        vector_wire::Header header;
+        std::memcpy(&header, message, sizeof(header));
+        vector_wire::CheckHeader<T>(header);
+        const size_t count = static_cast<size_t>(header.count);
+        if ((size - vector_wire::HEADER_SIZE) / sizeof(T) < count) {
+            throw std::runtime_error("vector_wire: message is truncated");
+        }
+        const void* payload = static_cast<const unsigned char*>(message) + vector_wire::HEADER_SIZE;
+        if (reinterpret_cast<std::uintptr_t>(payload) % alignof(T) != 0) {
+            throw std::runtime_error("vector_wire: message buffer is misaligned for the element type");
+        }
+        if (verify_checksum && vector_wire::Checksum(payload, count * sizeof(T)) != header.checksum) {
+            throw std::runtime_error("vector_wire: checksum mismatch");
+        }
+        return VectorView(static_cast<const T*>(payload), count);
+    }
+
+    const T* begin() const noexcept {
+        return data_;
+    }
+    const T* end() const noexcept {
+        return data_ + size_;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        VECTOR_CHECK(index < size_, "index %zu out of range for size %zu", index, size_);
+        return data_[index];
+    }
+
+    const T* Data() const noexcept {
+        return data_;
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    // Копия элементов во владеющий вектор
+    template <typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth>
+    Vector<T, Allocator, GrowthPolicy> ToVector(const Allocator& alloc = Allocator()) const {
+        Vector<T, Allocator, GrowthPolicy> result(alloc);
+        result.Assign(data_, data_ + size_);
+        return result;
+    }
+
+private:
+    const T* data_ = nullptr;
+    size_t size_ = 0;
+};